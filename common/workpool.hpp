@@ -0,0 +1,214 @@
+/* Copyright 2024-2025 MarcosHCK
+ * This file is part of DAA-Final-Project.
+ *
+ * DAA-Final-Project is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DAA-Final-Project is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __COMMON_WORKPOOL__
+#define __COMMON_WORKPOOL__ 1
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/* Work-stealing thread pool: every thread owns a deque, pops its own work
+ * LIFO and steals FIFO from the others when it runs dry. Threads outside
+ * the pool (workers of another one included) share the first deque, and
+ * help running tasks while they wait on a TaskGroup, so a pool of one
+ * thread spawns nothing at all.
+ */
+class WorkPool
+{
+private:
+
+  struct Queue
+  {
+    std::mutex lock;
+    std::deque<std::function<void ()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+  std::mutex sleep;
+  std::condition_variable wake;
+  std::atomic<std::size_t> queued = 0;
+  bool stop = false;
+
+  // The pool whose worker this thread is, and its deque there
+  static inline thread_local std::pair<const WorkPool*, std::size_t> self = { nullptr, 0 };
+
+  inline std::size_t home () const
+    {
+      return std::get<0> (self) == this ? std::get<1> (self) : 0;
+    }
+
+  inline bool take (std::size_t at, bool lifo, std::function<void ()>& task)
+    {
+      auto& q = *queues [at];
+      std::lock_guard<std::mutex> guard (q.lock);
+
+      if (q.tasks.empty ())
+
+        return false;
+
+      if (lifo)
+        (task = std::move (q.tasks.back ()), q.tasks.pop_back ());
+      else
+        (task = std::move (q.tasks.front ()), q.tasks.pop_front ());
+      return (--queued, true);
+    }
+
+  inline void loop (std::size_t at)
+    {
+      self = std::make_pair (this, at);
+
+      while (true) if (run_one () == false)
+        {
+          std::unique_lock<std::mutex> guard (sleep);
+
+          if (stop == true)
+
+            return;
+
+          wake.wait (guard, [this] { return stop || queued > 0; });
+        }
+    }
+
+public:
+
+  inline WorkPool (unsigned nthreads) : queues (std::max (1u, nthreads))
+    {
+      for (auto& q : queues) q = std::make_unique<Queue> ();
+      for (std::size_t i = 1; i < queues.size (); ++i) threads.emplace_back (&WorkPool::loop, this, i);
+    }
+
+  inline ~WorkPool ()
+    {
+      {
+        std::lock_guard<std::mutex> guard (sleep);
+        stop = true;
+      }
+
+      wake.notify_all ();
+      for (auto& t : threads) t.join ();
+    }
+
+  inline constexpr std::size_t size () const { return queues.size (); }
+
+  inline void spawn (std::function<void ()>&& task)
+    {
+      {
+        auto& q = *queues [home ()];
+        std::lock_guard<std::mutex> guard (q.lock);
+        (q.tasks.push_back (std::move (task)), ++queued);
+      }
+
+      {
+        std::lock_guard<std::mutex> guard (sleep);
+      }
+
+      wake.notify_one ();
+    }
+
+  inline bool run_one ()
+    {
+      std::function<void ()> task;
+      auto n = queues.size ();
+      auto s = home ();
+      auto f = take (s, true, task);
+
+      for (std::size_t i = 1; i < n && f == false; ++i) f = take ((s + i) % n, false, task);
+      return (f == true ? (task (), true) : false);
+    }
+};
+
+/* Tasks spawned on a pool (or run inline, without one) to be joined at once */
+class TaskGroup
+{
+private:
+
+  WorkPool* pool;
+  std::atomic<std::size_t> count = 0;
+  std::exception_ptr error = nullptr;
+  std::condition_variable done;
+  std::mutex lock;
+
+  /* Helps while there is anything to steal, and sleeps on `done` otherwise;
+   * the short timeout only lets it help again with tasks spawned meanwhile.
+   * Returning with `lock` taken once means the last task let go of it, so
+   * the group may go away right after.
+   */
+  inline void drain ()
+    {
+      while (true) if (count == 0 || pool->run_one () == false)
+        {
+          std::unique_lock<std::mutex> guard (lock);
+
+          if (done.wait_for (guard, std::chrono::milliseconds (1), [this] { return count == 0; }))
+
+            return;
+        }
+    }
+
+public:
+
+  inline TaskGroup (WorkPool* pool) : pool (pool)
+    {
+    }
+
+  /* Still joins when unwinding past the group, as pending tasks may point
+   * into the frame going away; their errors are dropped then
+   */
+  inline ~TaskGroup ()
+    {
+      drain ();
+    }
+
+  template<typename F> inline void spawn (F&& task)
+    {
+      if (pool == nullptr)
+
+        task ();
+      else
+        {
+          ++count;
+          pool->spawn ([this, task = std::forward<F> (task)] () mutable
+            {
+              try { task (); } catch (...)
+                {
+                  std::lock_guard<std::mutex> guard (lock);
+                  if (error == nullptr) error = std::current_exception ();
+                }
+
+              std::lock_guard<std::mutex> guard (lock);
+              if (--count == 0) done.notify_all ();
+            });
+        }
+    }
+
+  inline void wait ()
+    {
+      drain ();
+      if (error != nullptr) std::rethrow_exception (error);
+    }
+};
+
+#endif // __COMMON_WORKPOOL__
@@ -0,0 +1,282 @@
+/* Copyright 2024-2025 MarcosHCK
+ * This file is part of DAA-Final-Project.
+ *
+ * DAA-Final-Project is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DAA-Final-Project is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+ */
+#define CONFERENCE_NO_MAIN
+#include "solution.cpp"
+#include <cmath>
+#include <random>
+
+/* Times the solver phases one by one over generated instances and writes
+ * one JSON object per line on stdout:
+ *
+ *   {"kind":"dense","n":1000,"phase":"cleanse","ms":0.41}
+ *
+ * Phases whose input would not fit (quadratic coincidence sets, product
+ * spaces beyond --space) are reported with "skipped" instead of "ms".
+ */
+
+using C = std::uint8_t;
+using P = std::uint32_t;
+using Case = Participants<C, P>;
+
+enum class Kind
+{
+  known,
+  sparse,
+  dense,
+  overlap,
+  chain,
+};
+
+static const std::array<std::pair<Kind, const char*>, 5> kinds =
+  {{
+    { Kind::known, "known" },
+    { Kind::sparse, "sparse" },
+    { Kind::dense, "dense" },
+    { Kind::overlap, "overlap" },
+    { Kind::chain, "chain" },
+  }};
+
+struct Bench
+{
+  std::size_t max = 100000;
+  std::size_t reps = 3;
+  std::uint64_t seed = 1;
+  double space = 1 << 16;
+  std::size_t edges = 50000000;
+  std::size_t btree = 100;
+};
+
+// Results land here so the optimizer cannot drop the timed calls
+static volatile std::size_t sink;
+
+/* Instances come out sorted by start, as read_case leaves them:
+ *
+ *   known    short random intervals, every country given
+ *   sparse   as known, one participant in twenty unknown
+ *   dense    as known, half of them unknown
+ *   overlap  every interval holds a common day, one in ten unknown
+ *   chain    each interval meets only its neighbours, one in ten unknown
+ */
+static Case generate (Kind kind, std::size_t n, std::uint64_t seed)
+{
+  constexpr C ncountries = 4;
+
+  Case vec;
+  std::mt19937_64 rng (seed);
+  auto uniform = [&rng](P lo, P hi) { return std::uniform_int_distribution<P> (lo, hi) (rng); };
+  auto country = [&](unsigned unknown) { return C (uniform (1, 100) <= unknown ? 0 : uniform (1, ncountries)); };
+
+  vec.reserve (n);
+
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      P s = 0, e = 0;
+      C c = 0;
+
+      switch (kind)
+        {
+          case Kind::known: s = uniform (1, 4 * n); e = s + uniform (0, 8); c = country (0); break;
+          case Kind::sparse: s = uniform (1, 4 * n); e = s + uniform (0, 8); c = country (5); break;
+          case Kind::dense: s = uniform (1, 4 * n); e = s + uniform (0, 8); c = country (50); break;
+          case Kind::overlap: s = uniform (1, n); e = n + uniform (0, n); c = country (10); break;
+          case Kind::chain: s = 2 * i + 1; e = s + 2; c = country (10); break;
+        }
+
+      vec.push_back (c, s, e);
+    }
+
+  return (vec.sort (), vec);
+}
+
+/* Size of the coincidence sets without building them: p meets every
+ * interval starting by its end minus those ended before its start.
+ */
+static std::size_t edges (const Case& vec)
+{
+  std::size_t total = 0;
+  std::vector<P> starts = vec.starts, ends = vec.ends;
+
+  std::sort (starts.begin (), starts.end ());
+  std::sort (ends.begin (), ends.end ());
+
+  for (std::size_t p = 0; p < vec.size (); ++p)
+    {
+      auto began = std::upper_bound (starts.begin (), starts.end (), vec.ends [p]) - starts.begin ();
+      auto ended = std::lower_bound (ends.begin (), ends.end (), vec.starts [p]) - ends.begin ();
+      total += began - ended;
+    }
+
+  return total;
+}
+
+/* Best of reps runs of f; prepare resets the input outside the clock */
+template<typename F, typename G> static double measure (std::size_t reps, G&& prepare, F&& f)
+{
+  double best = std::numeric_limits<double>::infinity ();
+
+  for (std::size_t i = 0; i < reps; ++i)
+    {
+      prepare ();
+
+      auto start = std::chrono::steady_clock::now ();
+      f ();
+      auto elapsed = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+
+      best = std::min (best, elapsed);
+    }
+
+  return best;
+}
+
+static void report (const char* kind, std::size_t n, const char* phase, double ms)
+{
+  std::cout << "{\"kind\":\"" << kind << "\",\"n\":" << n << ",\"phase\":\"" << phase << "\",\"ms\":" << ms << "}" << '\n';
+}
+
+static void skip (const char* kind, std::size_t n, const char* phase, const char* why)
+{
+  std::cout << "{\"kind\":\"" << kind << "\",\"n\":" << n << ",\"phase\":\"" << phase << "\",\"skipped\":\"" << why << "\"}" << '\n';
+}
+
+static void run (const Bench& bench, Kind kind, const char* name, std::size_t n)
+{
+  using BitNode = BitNode<P, 512>;
+
+  const auto vec = generate (kind, n, bench.seed ^ n);
+  const auto nop = [] () { };
+
+  auto tree = [&]<typename TTree> (const char* phase)
+    {
+      report (name, n, phase, measure (bench.reps, nop, [&] () { (void) index<C, P, TTree> (vec); }));
+    };
+
+  // BTree keeps the union of its children on every inner node, which makes
+  // construction quadratic; past --btree it only adds minutes to a run
+  if (n <= bench.btree)
+    tree.template operator()<BTree<P, BNode<P>, P>> ("btree-bnode");
+  else
+    skip (name, n, "btree-bnode", "btree");
+
+  tree.template operator()<FlatTree<P, BNode<P>, P>> ("flattree-bnode");
+
+  if (n <= BitNode::capacity)
+    {
+      tree.template operator()<BTree<P, BitNode, P>> ("btree-bitnode");
+      tree.template operator()<FlatTree<P, BitNode, P>> ("flattree-bitnode");
+    }
+
+  if (kind == Kind::known)
+    {
+      auto flat = index<C, P, FlatTree<P, BNode<P>, P>> (vec);
+
+      report (name, n, "upset_tree", measure (bench.reps, nop, [&] () { sink = upset_tree (vec, flat); }));
+      report (name, n, "upset_known", measure (bench.reps, nop, [&] () { sink = upset_known (vec); }));
+    }
+
+  if (edges (vec) > bench.edges)
+    {
+      for (auto phase : { "sweep", "coincide", "cleanse", "genavail", "upset_count", "optimize" })
+
+        skip (name, n, phase, "edges");
+      return;
+    }
+
+  Coincidence<P> coin;
+
+  report (name, n, "sweep", measure (bench.reps, nop, [&] () { sink = (coin = Coincidence<P>::sweep (vec)).edges (); }));
+  report (name, n, "coincide", measure (bench.reps, nop, [&] () { sink = coincide<C, P, FlatTree<P, BNode<P>, P>> (vec).edges (); }));
+
+  P upset, zeros;
+  Case work, clean;
+  Coincidence<P> scratch;
+
+  report (name, n, "cleanse", measure (bench.reps, [&] () { (work = vec, scratch = coin); }, [&] ()
+    {
+      sink = (clean = cleanse (std::move (work), scratch, &upset, &zeros)).size ();
+    }));
+
+  std::map<P, std::set<C>> avail;
+
+  report (name, n, "genavail", measure (bench.reps, nop, [&] () { sink = (avail = genavail (clean, scratch)).size (); }));
+  report (name, n, "upset_count", measure (bench.reps, nop, [&] () { sink = upset_count (clean, scratch); }));
+
+  double space = 1;
+
+  for (const auto& [_, set] : avail) space *= std::max<std::size_t> (1, set.size ());
+
+  if (space > bench.space)
+
+    skip (name, n, "optimize", "space");
+  else
+    {
+      std::map<P, std::set<C>> copy;
+
+      report (name, n, "optimize", measure (bench.reps, [&] () { (work = clean, copy = avail); }, [&] ()
+        {
+          sink = optimize (work, scratch, std::move (copy));
+        }));
+    }
+}
+
+static inline bool parse (int argc, char* argv [], Bench* bench)
+{
+  for (int i = 1; i < argc; ++i)
+    {
+      auto arg = std::string (argv [i]);
+      auto value = [&](const std::string& name) { return arg.substr (name.size ()); };
+      auto number = [&](const std::string& name) { return arg.starts_with (name) && value (name).size () > 0 && value (name).find_first_not_of ("0123456789") == std::string::npos; };
+
+      if (number ("--max="))
+        bench->max = std::stoull (value ("--max="));
+      else if (number ("--reps="))
+        bench->reps = std::max (1ull, std::stoull (value ("--reps=")));
+      else if (number ("--seed="))
+        bench->seed = std::stoull (value ("--seed="));
+      else if (number ("--space="))
+        bench->space = std::stod (value ("--space="));
+      else if (number ("--edges="))
+        bench->edges = std::stoull (value ("--edges="));
+      else if (number ("--btree="))
+        bench->btree = std::stoull (value ("--btree="));
+      else
+        {
+          std::cerr << "usage: " << argv [0] << " [--max=N] [--reps=N] [--seed=N] [--space=N] [--edges=N] [--btree=N]" << std::endl;
+          return false;
+        }
+    }
+
+  return true;
+}
+
+int main (int argc, char* argv [])
+{
+  Bench bench;
+
+  if (parse (argc, argv, &bench) == false)
+
+    return 1;
+
+  for (std::size_t n = 10; n <= bench.max; n *= 10)
+
+    for (const auto& [kind, name] : kinds)
+      {
+        run (bench, kind, name, n);
+        std::cout << std::flush;
+      }
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+/* Copyright 2024-2025 MarcosHCK
+ * This file is part of DAA-Final-Project.
+ *
+ * DAA-Final-Project is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * DAA-Final-Project is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+/* Reference answers for test.sh: tries every country known in the case,
+ * plus one nobody holds, on every unknown participant, and counts upset
+ * participants straight from the definition. Exponential, so only fit
+ * for a handful of unknowns.
+ */
+template<typename C, typename P> class Problem
+{
+private:
+
+  std::vector<std::tuple<P, P, C>> people;
+  std::vector<C> countries;
+  std::vector<P> unknowns;
+
+  inline bool meet (P a, P b) const
+    {
+      return std::get<0> (people [a]) <= std::get<1> (people [b]) && std::get<0> (people [b]) <= std::get<1> (people [a]);
+    }
+
+  inline P count (const std::vector<C>& held) const
+    {
+      P upset = 0;
+
+      for (P p = 0; p < people.size (); ++p)
+        {
+          bool f = true;
+
+          for (P q = 0; q < people.size () && f; ++q) if (meet (p, q) && held [p] != held [q])
+            f = false;
+          if (f == true) ++upset;
+        }
+
+      return upset;
+    }
+
+  inline P search (std::vector<C>& held, std::size_t i) const
+    {
+      P best = 0;
+
+      if (i == unknowns.size ())
+
+        return count (held);
+
+      for (const auto& c : countries)
+        {
+          held [unknowns [i]] = c;
+          best = std::max (best, search (held, 1 + i));
+        }
+
+      return best;
+    }
+
+public:
+
+  inline Problem (std::vector<std::tuple<P, P, C>>&& people) : people (std::move (people))
+    {
+      std::set<C> known;
+
+      for (P p = 0; p < this->people.size (); ++p)
+        {
+          auto c = std::get<2> (this->people [p]);
+
+          if (c == 0)
+            unknowns.push_back (p);
+          else
+            known.insert (c);
+        }
+
+      countries.assign (known.begin (), known.end ());
+      countries.push_back (known.size () == 0 ? 1 : 1 + *known.rbegin ());
+    }
+
+  inline P solve () const
+    {
+      std::vector<C> held;
+
+      for (const auto& e : people) held.push_back (std::get<2> (e));
+      return search (held, 0);
+    }
+};
+
+int main ()
+{
+  unsigned ncases, npeople;
+  unsigned start, end, country;
+
+  std::cin >> ncases;
+
+  for (unsigned i = 0; i < ncases; ++i)
+    {
+      std::vector<std::tuple<unsigned, unsigned, unsigned>> people;
+
+      std::cin >> npeople;
+
+      for (unsigned j = 0; j < npeople; ++j)
+        {
+          std::cin >> start >> end >> country;
+          people.push_back (std::make_tuple (start, end, country));
+        }
+
+      std::cout << Problem<unsigned, unsigned> (std::move (people)).solve () << std::endl;
+    }
+
+  return 0;
+}
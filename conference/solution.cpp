@@ -15,12 +15,34 @@
  * along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <set>
+#include <span>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+#include <workpool.hpp>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+# define CONFERENCE_X86 1
+# include <immintrin.h>
+#endif
 
 template<typename TClass> class BNode
 {
@@ -38,6 +60,12 @@ public:
     {
     }
 
+  // Spelled out: the copy constructor above would otherwise turn every
+  // `node = BNode (val, std::move (node))` into a full set copy
+  inline BNode (BNode<TClass>&& o) = default;
+  inline BNode& operator= (const BNode<TClass>& o) = default;
+  inline BNode& operator= (BNode<TClass>&& o) = default;
+
   inline BNode (TClass&& val, BNode<TClass>&& o) : segments (std::move (o.segments))
     {
       segments.insert (std::move (val));
@@ -58,6 +86,118 @@ public:
     }
 };
 
+/* Fixed width alternative to BNode, for index spaces known to fit in N bits
+ * (participant count is bounded by 500): union is a word-wise OR and lookup
+ * walks set bits, so no node ever touches the allocator.
+ */
+template<typename TClass, std::size_t N> class BitNode
+{
+public:
+
+  static const std::size_t capacity = N;
+
+private:
+
+  using word_type = std::uint64_t;
+  static const std::size_t bits = 8 * sizeof (word_type);
+  static const std::size_t words = (N + bits - 1) / bits;
+
+  alignas (32) std::array<word_type, words> segments = { };
+
+public:
+
+  class iterator
+  {
+  private:
+
+    const word_type* at;
+    const word_type* end;
+    word_type word;
+    std::size_t base;
+
+    inline void skip ()
+      {
+        while (word == 0 && at != end) if (++at != end)
+          {
+            word = *at;
+            base += bits;
+          }
+      }
+
+  public:
+
+    inline iterator (const word_type* at, const word_type* end) : at (at), end (end), word (at != end ? *at : 0), base (0)
+      {
+        skip ();
+      }
+
+    inline TClass operator* () const
+      {
+        return static_cast<TClass> (base + std::countr_zero (word));
+      }
+
+    inline iterator& operator++ ()
+      {
+        word &= word - 1;
+        return (skip (), *this);
+      }
+
+    inline bool operator== (const iterator& o) const { return at == o.at && word == o.word; }
+    inline bool operator!= (const iterator& o) const { return ! (*this == o); }
+  };
+
+  inline BitNode ()
+    {
+    }
+
+  inline BitNode (const BitNode<TClass, N>& o) : segments (o.segments)
+    {
+    }
+
+  inline BitNode (TClass&& val, BitNode<TClass, N>&& o) : segments (o.segments)
+    {
+      if (static_cast<std::size_t> (val) >= N)
+
+        std::__throw_out_of_range ("BitNode index out of range");
+
+      segments [val / bits] |= word_type (1) << (val % bits);
+    }
+
+  inline BitNode (const BitNode<TClass, N>& a, const BitNode<TClass, N>& b)
+    {
+      std::size_t i = 0;
+#if defined (__AVX2__)
+      for (; i + 4 <= words; i += 4)
+        {
+          auto x = _mm256_load_si256 ((const __m256i*) & a.segments [i]);
+          auto y = _mm256_load_si256 ((const __m256i*) & b.segments [i]);
+          _mm256_store_si256 ((__m256i*) & segments [i], _mm256_or_si256 (x, y));
+        }
+#endif
+      for (; i < words; ++i) segments [i] = a.segments [i] | b.segments [i];
+    }
+
+  inline BitNode<TClass, N>& operator= (const BitNode<TClass, N>& o) = default;
+
+  inline iterator begin () const { return iterator (segments.data (), segments.data () + words); }
+  inline iterator end () const { return iterator (segments.data () + words, segments.data () + words); }
+
+  inline constexpr const BitNode<TClass, N>& lookup () const
+    {
+      return *this;
+    }
+
+  inline std::size_t size () const
+    {
+      std::size_t n = 0;
+      for (const auto& w : segments) n += std::popcount (w);
+      return n;
+    }
+
+  inline bool operator< (const BitNode<TClass, N>& o) const { return segments < o.segments; }
+  inline bool operator== (const BitNode<TClass, N>& o) const { return segments == o.segments; }
+};
+
 template<typename TInterval, typename TNode, typename TVal> class BTree
 {
 private:
@@ -67,6 +207,13 @@ private:
   std::unique_ptr<BTree<TInterval, TNode, TVal>> right = nullptr;
   TNode value;
 
+public:
+
+  using node_type = TNode;
+  using set_type = std::decay_t<decltype (std::declval<const TNode&> ().lookup ())>;
+
+private:
+
   inline BTree* get_left ()
     {
       if (left == nullptr) split ();
@@ -140,6 +287,27 @@ private:
         }
     }
 
+  template<typename F> inline bool visiti (TInterval l, TInterval r, F& f) const
+    {
+      if (left == nullptr && right == nullptr)
+        {
+          for (const auto& j : value.lookup ()) if (f (j) == false)
+            return false;
+          return true;
+        }
+      else
+        {
+          auto m = mid (start, end);
+
+          if (l > m)
+            return right->visiti (l, r, f);
+          else if (m >= r)
+            return left->visiti (l, r, f);
+          else
+            return left->visiti (l, m, f) && right->visiti (m + 1, r, f);
+        }
+    }
+
   static inline TInterval mid (TInterval l, TInterval r)
     {
       return l + (r - l) / 2;
@@ -175,213 +343,2605 @@ public:
     {
       return lookupi (l, r).lookup ();
     }
+
+  /* Calls f (index) for the values stored on every leaf meeting [l, r],
+   * without building their union (so an index spanning several leaves is
+   * seen once per leaf), until f returns false. Returns whether the walk
+   * ran to the end.
+   */
+  template<typename F> inline bool visit (TInterval l, TInterval r, F&& f) const
+    {
+      return visiti (l, r, f);
+    }
+
+  /* Whether some value stored over [l, r] satisfies pred, stopping at the first */
+  template<typename F> inline bool any (TInterval l, TInterval r, F&& pred) const
+    {
+      return visit (l, r, [&pred](const TVal& j) { return ! pred (j); }) == false;
+    }
 };
 
-template<typename C, typename P> inline std::vector<std::tuple<C, P, P>> cleanse (std::vector<std::tuple<C, P, P>>&& vec, const BTree<P, BNode<P>, P>& tree, P* upset, P* zeros)
+/* Array backed alternative to BTree over the compressed set of interval
+ * endpoints (so at most 2n distinct points, whatever the day range). Nodes
+ * live in one vector with implicit children and keep two sets each: `cover`
+ * holds values whose interval spans the whole node, `touch` every value
+ * inserted anywhere below it, which bounds memory to O(n log n) entries.
+ * Intervals passed to insert and lookup must use the endpoints given at
+ * construction.
+ */
+template<typename TInterval, typename TNode, typename TVal> class FlatTree
 {
-  P i = 0;
-  P zerocount = 0;
-  std::set<P> useless;
+private:
+
+  struct Node
+  {
+    TNode cover;
+    TNode touch;
+  };
 
-  for (auto iter = vec.begin (); iter != vec.end (); ++i, ++iter) if (std::get<0> (*iter) == 0)
+  std::vector<TInterval> points;
+  std::vector<Node> nodes;
+
+  static inline std::size_t left (std::size_t node) { return 2 * node + 1; }
+  static inline std::size_t mid (std::size_t l, std::size_t r) { return l + (r - l) / 2; }
+  static inline std::size_t right (std::size_t node) { return 2 * node + 2; }
+
+  inline std::size_t compress (const TInterval& x) const
     {
-      auto e = std::get<1> (*iter);
-      auto s = std::get<2> (*iter);
-      bool f = true;
+      auto at = std::lower_bound (points.begin (), points.end (), x);
+
+      if (at == points.end () || *at != x)
+
+        std::__throw_out_of_range ("interval endpoint was not given to FlatTree");
 
-      for (const auto& j : tree.lookup (s, e)) if (std::get<0> (vec [j]) != 0) f = false;
-      if (f == true) useless.insert (i);
-      ++zerocount;
+      return at - points.begin ();
     }
 
-  std::vector<std::tuple<C, P, P>> clean;
-  i = 0;
+  inline void inserti (std::size_t node, std::size_t start, std::size_t end, std::size_t l, std::size_t r, const TVal& val)
+    {
+      auto& n = nodes [node];
 
-  clean.reserve (vec.size () - useless.size ());
+      n.touch = TNode (TVal (val), std::move (n.touch));
 
-  for (auto iter = std::make_move_iterator (vec.begin ()); iter != std::make_move_iterator (vec.end ()); ++i, ++iter)
+      if (l == start && r == end)
 
-    if ((useless.find (i) != useless.end ()) == false)
-      {
-        clean.push_back (*iter);
-      }
+        n.cover = TNode (TVal (val), std::move (n.cover));
+      else
+        {
+          auto m = mid (start, end);
 
-  return (*upset = useless.size (), *zeros = zerocount, std::move (clean));
-}
+          if (l > m)
+            inserti (right (node), m + 1, end, l, r, val);
+          else if (m >= r)
+            inserti (left (node), start, m, l, r, val);
+          else
+            {
+              inserti (left (node), start, m, l, m, val);
+              inserti (right (node), m + 1, end, m + 1, r, val);
+            }
+        }
+    }
 
-template<typename C, typename P> inline std::map<P, std::set<C>> genavail (const std::vector<std::tuple<C, P, P>>& vec, const BTree<P, BNode<P>, P>& tree)
-{
-  C c;
-  P i = 0;
-  std::map<P, std::set<C>> avail;
+  inline const TNode lookupi (std::size_t node, std::size_t start, std::size_t end, std::size_t l, std::size_t r) const
+    {
+      const auto& n = nodes [node];
+
+      if (l == start && r == end)
+
+        return n.touch;
+      else
+        {
+          auto m = mid (start, end);
+
+          if (l > m)
+            return TNode (n.cover, lookupi (right (node), m + 1, end, l, r));
+          else if (m >= r)
+            return TNode (n.cover, lookupi (left (node), start, m, l, r));
+          else
+            {
+              auto lt = lookupi (left (node), start, m, l, m);
+              auto rt = lookupi (right (node), m + 1, end, m + 1, r);
+              return TNode (n.cover, TNode (lt, rt));
+            }
+        }
+    }
 
-  for (auto iter = vec.begin (); iter != vec.end (); ++i, ++iter) if (std::get<0> (*iter) == 0)
+  template<typename F> inline bool visiti (std::size_t node, std::size_t start, std::size_t end, std::size_t l, std::size_t r, F& f) const
     {
-      std::set<C> r;
-      auto e = std::get<1> (*iter);
-      auto s = std::get<2> (*iter);
+      const auto& n = nodes [node];
+      const auto& here = (l == start && r == end) ? n.touch : n.cover;
+
+      for (const auto& j : here.lookup ()) if (f (j) == false)
+        return false;
 
-      for (const auto& j : tree.lookup (s, e))
+      if (l == start && r == end)
+
+        return true;
+      else
         {
-          if ((c = std::get<0> (vec [j])) != 0)
-            r.insert (c);
+          auto m = mid (start, end);
+
+          if (l > m)
+            return visiti (right (node), m + 1, end, l, r, f);
+          else if (m >= r)
+            return visiti (left (node), start, m, l, r, f);
+          else
+            return visiti (left (node), start, m, l, m, f) && visiti (right (node), m + 1, end, m + 1, r, f);
         }
-      avail.insert (std::make_pair (i, std::move (r)));
     }
 
-  return std::move (avail);
-}
+public:
 
-template<typename C, typename P> using Memorizer = std::map<std::set<P>, bool>;
+  using node_type = TNode;
+  using set_type = std::decay_t<decltype (std::declval<const TNode&> ().lookup ())>;
 
-template<typename C, typename P> inline P upset_count (const std::vector<std::tuple<C, P, P>>& vec, const BTree<P, BNode<P>, P>& tree, Memorizer<C, P>* memo = nullptr)
-{
-  P i = 0;
-  P upset = 0;
-  typename Memorizer<C, P>::const_iterator at;
+  inline FlatTree (std::vector<TInterval>&& endpoints) : points (std::move (endpoints))
+    {
+      std::sort (points.begin (), points.end ());
+      points.erase (std::unique (points.begin (), points.end ()), points.end ());
+
+      if (points.size () == 0)
+
+        std::__throw_invalid_argument ("empty FlatTree interval set");
 
-  for (auto iter = vec.begin (); iter != vec.end (); ++i, ++iter)
+      nodes.resize (4 * points.size ());
+    }
+
+  inline constexpr std::size_t size () const { return nodes.size (); }
+
+  inline void insert (const TInterval& l, const TInterval& r, TVal&& val)
     {
-      auto c = std::get<0> (*iter);
-      auto e = std::get<1> (*iter);
-      auto s = std::get<2> (*iter);
-      auto n = tree.lookup (s, e);
-      auto f = true;
+      auto a = compress (l);
+      auto b = compress (r);
 
-      if (memo != nullptr && (at = memo->find (n)) != memo->end ())
+      if (a > b)
 
-        f = std::get<1> (*at);
-      else
-        {
-          for (const auto& j : n)
-            {
-              auto k = std::get<0> (vec [j]);
-              if (c != k) { f = false; break; }
-            }
+        std::__throw_out_of_range ("inserting segment out of range");
 
-          if (memo != nullptr)
+      inserti (0, 0, points.size () - 1, a, b, val);
+    }
 
-            memo->insert (std::make_pair (n, f));
-        }
+  inline const auto lookup (TInterval l, TInterval r) const
+    {
+      return lookupi (0, 0, points.size () - 1, compress (l), compress (r)).lookup ();
+    }
 
-      if (f == true) ++upset;
+  /* Same contract as BTree::visit, over the canonical nodes of [l, r] */
+  template<typename F> inline bool visit (TInterval l, TInterval r, F&& f) const
+    {
+      return visiti (0, 0, points.size () - 1, compress (l), compress (r), f);
     }
 
-  return upset;
-}
+  template<typename F> inline bool any (TInterval l, TInterval r, F&& pred) const
+    {
+      return visit (l, r, [&pred](const TVal& j) { return ! pred (j); }) == false;
+    }
+};
 
-template<typename C, typename P> inline P optimize (std::vector<std::tuple<C, P, P>>& vec, const BTree<P, BNode<P>, P>& tree, std::map<P, std::set<C>>&& avail)
+/* Participants as parallel arrays, sorted by start by whoever builds them.
+ * Searches only ever rewrite and compare `countries`, so with a narrow C
+ * the array they sweep once per configuration stays a few lines long;
+ * `ids` keeps each one's position at push_back time, so answers can name
+ * participants after sorting and filtering moved them around.
+ */
+template<typename C, typename P> struct Participants
 {
-  P b, best = 0;
-  Memorizer<C, P> memo;
-  std::vector<std::set<C>*> sets;
-  std::vector<P> idxs;
-  std::vector<typename std::set<C>::const_iterator> iters;
+  std::vector<C> countries;
+  std::vector<P> starts;
+  std::vector<P> ends;
+  std::vector<P> ids;
 
-  idxs.reserve (avail.size ());
-  iters.reserve (avail.size ());
-  sets.reserve (avail.size ());
+  inline std::size_t size () const { return countries.size (); }
 
-  for (auto iter = avail.begin (); iter != avail.end (); ++iter)
+  inline void reserve (std::size_t n)
     {
-      idxs.push_back (std::get<0> (*iter));
-      iters.push_back ((std::get<1> (*iter)).begin ());
-      sets.push_back (& std::get<1> (*iter));
+      (countries.reserve (n), starts.reserve (n), ends.reserve (n), ids.reserve (n));
     }
 
-  while (true)
+  inline void push_back (C country, P start, P end)
     {
-      for (int i = 0; i < iters.size (); ++i)
-        {
-          auto k = (idxs [i]);
-          auto c = *(iters [i]);
-          auto e = std::get<1> (vec [k]);
-          auto s = std::get<2> (vec [k]);
+      push_back (country, start, end, (P) size ());
+    }
 
-          vec [k] = std::make_tuple (c, e, s);
-        }
+  inline void push_back (C country, P start, P end, P id)
+    {
+      (countries.push_back (country), starts.push_back (start), ends.push_back (end), ids.push_back (id));
+    }
 
-      if ((b = upset_count (vec, tree, &memo)) > best)
-        best = b;
+  /* Participants [begin, end) */
+  inline Participants slice (std::size_t begin, std::size_t end) const
+    {
+      Participants part;
 
-      for (int i = iters.size () - 1; i >= 0; --i)
-        {
-          if (++iters [i] != sets [i]->end ())
-            break;
-          else if (i == 0)
-            return best;
-        }
+      part.countries.assign (countries.begin () + begin, countries.begin () + end);
+      part.starts.assign (starts.begin () + begin, starts.begin () + end);
+      part.ends.assign (ends.begin () + begin, ends.begin () + end);
+      part.ids.assign (ids.begin () + begin, ids.begin () + end);
+      return part;
     }
-}
 
-template<typename C, typename P> inline P case_ ()
-{
-  P npeople;
-  std::cin >> npeople;
+  /* Participants with keep [p], in order */
+  inline Participants select (const std::vector<bool>& keep) const
+    {
+      Participants part;
 
-  C country;
-  P end, maxl = 0, start;
+      part.reserve (std::count (keep.begin (), keep.end (), true));
 
-  std::vector<std::tuple<C, P, P>> vec;
-  vec.reserve (npeople);
+      for (std::size_t p = 0; p < size (); ++p) if (keep [p]) part.push_back (countries [p], starts [p], ends [p], ids [p]);
+      return part;
+    }
 
-  for (P i = 0; i < npeople; ++i)
+  /* Stable sort by start, permuting the arrays alike */
+  inline void sort ()
     {
-      std::cin >> start >> end >> country;
+      std::vector<std::size_t> order (size ());
+      Participants sorted;
+
+      for (std::size_t p = 0; p < size (); ++p) order [p] = p;
+
+      std::stable_sort (order.begin (), order.end (), [this](std::size_t a, std::size_t b) { return starts [a] < starts [b]; });
+      sorted.reserve (size ());
 
-      maxl = std::max (maxl, end);
-      vec.push_back (std::make_tuple (country, end, start));
+      for (const auto& p : order) sorted.push_back (countries [p], starts [p], ends [p], ids [p]);
+      *this = std::move (sorted);
     }
+};
+
+/* Coincidence sets C_p of every participant, stored flat (CSR style): the
+ * neighbours of p are indices [offsets [p], offsets [p + 1]) of `indices`,
+ * sorted and including p itself. Offsets are std::size_t whatever P is,
+ * as the sets grow quadratically with the participants meeting at once.
+ */
+template<typename P> class Coincidence
+{
+private:
 
-  auto tree = BTree<P, BNode<P>, P> (0, maxl);
+  std::vector<std::size_t> offsets;
+  std::vector<P> indices;
 
-  std::sort (vec.begin (), vec.end (), [](const std::tuple<C, P, P>& a, const std::tuple<C, P, P>& b)
+  inline Coincidence (std::vector<std::size_t>&& offsets, std::vector<P>&& indices) : offsets (std::move (offsets)), indices (std::move (indices))
     {
-      return std::get<2> (a) < std::get<2> (b);
-    });
+    }
 
-  P i = 0;
-  P upset = 0;
-  P zeros = 0;
+public:
+
+  inline Coincidence () : offsets (1, 0)
+    {
+    }
+
+  inline constexpr std::span<const P> operator[] (P p) const
+    {
+      return std::span<const P> (indices.data () + offsets [p], offsets [p + 1] - offsets [p]);
+    }
+
+  inline constexpr P size () const { return offsets.size () - 1; }
+  inline constexpr std::size_t edges () const { return indices.size (); }
+  inline constexpr std::size_t bytes () const { return offsets.size () * sizeof (std::size_t) + indices.size () * sizeof (P); }
 
-  for (auto iter = vec.begin (); iter != vec.end (); ++iter)
+  /* Builds every C_p in one sweep over the (start, end) events, in
+   * O(n log n + output): when a participant arrives it meets exactly the
+   * participants still present, and each coincident pair is seen once.
+   */
+  template<typename C> static Coincidence<P> sweep (const Participants<C, P>& vec)
     {
-      auto c = std::get<0> (*iter);
-      auto e = std::get<1> (*iter);
-      auto s = std::get<2> (*iter);
+      P n = vec.size ();
+      std::vector<P> active, byend, bystart, pos (n);
+      std::vector<std::pair<P, P>> pairs;
+
+      byend.reserve (n);
+      bystart.reserve (n);
+
+      for (P i = 0; i < n; ++i) (byend.push_back (i), bystart.push_back (i));
+
+      std::sort (bystart.begin (), bystart.end (), [&vec](P a, P b) { return vec.starts [a] < vec.starts [b]; });
+      std::sort (byend.begin (), byend.end (), [&vec](P a, P b) { return vec.ends [a] < vec.ends [b]; });
+
+      auto gone = byend.begin ();
+
+      for (const auto& p : bystart)
+        {
+          auto s = vec.starts [p];
+
+          for (; gone != byend.end () && vec.ends [*gone] < s; ++gone)
+            {
+              auto q = *gone;
+              auto last = active.back ();
+              active [pos [q]] = last;
+              pos [last] = pos [q];
+              active.pop_back ();
+            }
+
+          pairs.push_back (std::make_pair (p, p));
 
-      tree.insert (s, e, i++);
-      if (c == 0) ++zeros;
+          for (const auto& q : active)
+            {
+              pairs.push_back (std::make_pair (p, q));
+              pairs.push_back (std::make_pair (q, p));
+            }
+
+          pos [p] = active.size ();
+          active.push_back (p);
+        }
+
+      return bucket (n, std::move (pairs));
     }
 
-  if (zeros == 0)
+  /* Same sets, read back from an interval tree holding participant indices */
+  template<typename C, typename TTree> static Coincidence<P> lookup (const Participants<C, P>& vec, const TTree& tree)
+    {
+      std::vector<P> indices;
+      std::vector<std::size_t> offsets;
 
-    upset = upset_count (vec, tree);
-  else
+      offsets.reserve (vec.size () + 1);
+      offsets.push_back (0);
+
+      for (std::size_t p = 0; p < vec.size (); ++p)
+        {
+          auto e = vec.ends [p];
+          auto s = vec.starts [p];
+
+          auto from = indices.size ();
+
+          tree.visit (s, e, [&indices](P j) { return (indices.push_back (j), true); });
+          std::sort (indices.begin () + from, indices.end ());
+          indices.erase (std::unique (indices.begin () + from, indices.end ()), indices.end ());
+          offsets.push_back (indices.size ());
+        }
+
+      return Coincidence<P> (std::move (offsets), std::move (indices));
+    }
+
+  /* Two stable counting passes (by neighbour, then by owner) leave every
+   * row sorted without a comparison sort.
+   */
+  static Coincidence<P> bucket (P n, std::vector<std::pair<P, P>>&& pairs)
     {
-      zeros = 0;
-      vec = cleanse (std::move (vec), tree, &upset, &zeros);
+      std::vector<std::size_t> count (n + 1, 0);
+      std::vector<std::pair<P, P>> tmp (pairs.size ());
 
-      if (zeros == 0)
+      for (const auto& e : pairs) ++count [std::get<1> (e) + 1];
+      for (P i = 0; i < n; ++i) count [i + 1] += count [i];
+      for (const auto& e : pairs) tmp [count [std::get<1> (e)]++] = e;
 
-        upset += upset_count (vec, tree);
-      else
-        upset += optimize (vec, tree, genavail (vec, tree));
+      std::vector<std::size_t> offsets (n + 1, 0);
+      std::vector<P> indices (tmp.size ());
+
+      for (const auto& e : tmp) ++offsets [std::get<0> (e) + 1];
+      for (P i = 0; i < n; ++i) offsets [i + 1] += offsets [i];
+
+      count.assign (offsets.begin (), offsets.end () - 1);
+
+      for (const auto& e : tmp) indices [count [std::get<0> (e)]++] = std::get<1> (e);
+      return Coincidence<P> (std::move (offsets), std::move (indices));
     }
 
-  return upset;
-}
+  /* Restricts the sets to participants with keep [p], renumbering them in order */
+  inline Coincidence<P> select (const std::vector<bool>& keep) const
+    {
+      P k = 0;
+      std::vector<P> indices, renum (size ());
+      std::vector<std::size_t> offsets;
 
-template<typename C, typename P> inline int program ()
-{
-  P ncases;
-  std::cin >> ncases;
+      for (P p = 0; p < size (); ++p) renum [p] = keep [p] ? k++ : k;
 
-  for (P i = 0; i < ncases; ++i) std::cout << case_<C, P> () << std::endl;
-  return 0;
-}
+      offsets.reserve (k + 1);
+      offsets.push_back (0);
+
+      for (P p = 0; p < size (); ++p) if (keep [p])
+        {
+          for (const auto& j : (*this) [p]) if (keep [j]) indices.push_back (renum [j]);
+          offsets.push_back (indices.size ());
+        }
+
+      return Coincidence<P> (std::move (offsets), std::move (indices));
+    }
+};
 
-int main ()
+/* Per case counters for --stats. Whatever fills them takes a Stats pointer,
+ * null unless asked for, counts locally and publishes once per call, so a
+ * disabled run pays a branch per phase and nothing in the inner loops.
+ */
+struct Stats
 {
-  return program<unsigned, unsigned> ();
-}
+  std::atomic<std::uint64_t> sweeps = 0, bytes = 0, edges = 0;
+  std::atomic<std::uint64_t> useless = 0, unknowns = 0, candidates = 0;
+  std::atomic<std::uint64_t> configs = 0, hits = 0, misses = 0, evictions = 0;
+  std::atomic<double> space = 0;
+  std::atomic<double> index = 0, cleanse = 0, genavail = 0, search = 0, count = 0;
+
+  /* Adds its own lifetime to one of the phase clocks (in ms) */
+  class Phase
+  {
+  private:
+
+    std::atomic<double>* clock;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+
+    inline Phase (Stats* stats, std::atomic<double> Stats::* clock) : clock (stats == nullptr ? nullptr : & (stats->*clock))
+      {
+        if (this->clock != nullptr) start = std::chrono::steady_clock::now ();
+      }
+
+    inline ~Phase ()
+      {
+        if (clock != nullptr) clock->fetch_add (std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ());
+      }
+  };
+
+  /* One coincidence sweep and what it holds */
+  template<typename P> inline void swept (const Coincidence<P>& coin)
+    {
+      (++sweeps, bytes += coin.bytes (), edges += coin.edges ());
+    }
+
+  /* Candidate sets of the unknowns searched together, and log2 of their product */
+  template<typename P, typename C> inline void domain (const std::map<P, std::set<C>>& avail)
+    {
+      std::uint64_t n = 0;
+      double bits = 0;
+
+      for (const auto& e : avail) (n += std::get<1> (e).size (), bits += std::log2 (std::max<std::size_t> (1, std::get<1> (e).size ())));
+      (unknowns += avail.size (), candidates += n, space.fetch_add (bits));
+    }
+
+  inline void print (std::ostream& out, std::size_t at) const
+    {
+      auto rate = hits + misses == 0 ? 0 : (double) hits / (double) (hits + misses);
+
+      out << "{\"case\":" << at
+          << ",\"sweeps\":" << sweeps << ",\"coin_bytes\":" << bytes << ",\"edges\":" << edges
+          << ",\"useless\":" << useless << ",\"unknowns\":" << unknowns << ",\"candidates\":" << candidates << ",\"space_log2\":" << space
+          << ",\"configs\":" << configs << ",\"memo_hits\":" << hits << ",\"memo_misses\":" << misses << ",\"memo_hit_rate\":" << rate << ",\"memo_evictions\":" << evictions
+          << ",\"ms\":{\"index\":" << index << ",\"cleanse\":" << cleanse << ",\"genavail\":" << genavail << ",\"search\":" << search << ",\"count\":" << count << "}}" << '\n';
+    }
+};
+
+/* Wall clock limit of a case (--budget-ms). Searches poll it every
+ * `stride` steps and give up once it passed, which marks it expired: a
+ * deadline still unexpired after a search means nothing was cut short.
+ */
+class Deadline
+{
+private:
+
+  std::chrono::steady_clock::time_point at;
+  mutable std::atomic<bool> expired = false;
+
+public:
+
+  static constexpr std::uint64_t stride = 1024;
+
+  inline Deadline (double ms) : at (std::chrono::steady_clock::now () + std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double, std::milli> (ms)))
+    {
+    }
+
+  inline bool get_expired () const { return expired.load (std::memory_order_relaxed); }
+
+  inline bool passed () const
+    {
+      if (get_expired () == false && std::chrono::steady_clock::now () >= at)
+
+        expired.store (true, std::memory_order_relaxed);
+      return get_expired ();
+    }
+};
+
+/* Connected components of the overlap graph, as [begin, end) runs of
+ * participants sorted by start: a run goes on while the next arrival is
+ * not past the latest departure seen so far.
+ */
+template<typename C, typename P> inline std::vector<std::pair<P, P>> components (const Participants<C, P>& vec)
+{
+  P begin = 0, last = 0;
+  std::vector<std::pair<P, P>> runs;
+
+  for (P i = 0; i < vec.size (); ++i)
+    {
+      auto e = vec.ends [i];
+      auto s = vec.starts [i];
+
+      if (i > 0 && s > last)
+
+        (runs.push_back (std::make_pair (begin, i)), begin = i);
+
+      last = i == begin ? e : std::max (last, e);
+    }
+
+  if (vec.size () > 0) runs.push_back (std::make_pair (begin, (P) vec.size ()));
+  return runs;
+}
+
+/* Components holding no known country at all take one country and end up
+ * upset whole. Their participants leave the search here, counted in
+ * `upset` (and their ids listed in `dropped`); everything else stays.
+ */
+template<typename C, typename P> inline Participants<C, P> cleanse (Participants<C, P>&& vec, Coincidence<P>& coin, P* upset, P* zeros, std::vector<P>* dropped = nullptr)
+{
+  P useless = 0;
+  P zerocount = 0;
+  std::vector<bool> keep (vec.size (), true);
+
+  for (const auto& [begin, end] : components (vec))
+    {
+      auto none = std::all_of (vec.countries.begin () + begin, vec.countries.begin () + end, [](C c) { return c == 0; });
+
+      for (auto i = begin; i < end; ++i) if (vec.countries [i] == 0)
+        {
+          if (none == true) (keep [i] = false, ++useless);
+          if (none == true && dropped != nullptr) dropped->push_back (vec.ids [i]);
+          ++zerocount;
+        }
+    }
+
+  // Indices shift once useless participants go away
+  if (useless > 0) (vec = vec.select (keep), coin = coin.select (keep));
+
+  return (*upset = useless, *zeros = zerocount - useless, std::move (vec));
+}
+
+/* Candidates of every unknown: the known countries met by any unknown it
+ * reaches through unknowns. Those met by itself do not suffice, as a
+ * chain of unknowns may carry the country at one end all the way along
+ * (upsetting every one of them), while a country no known participant
+ * around the chain holds never does better than one of those.
+ */
+template<typename C, typename P> inline std::map<P, std::set<C>> genavail (const Participants<C, P>& vec, const Coincidence<P>& coin)
+{
+  C c;
+  std::map<P, std::set<C>> avail, near;
+  std::vector<P> root (vec.size ());
+
+  auto find = [&root](P x)
+    {
+      while (root [x] != x) x = root [x] = root [root [x]];
+      return x;
+    };
+
+  std::iota (root.begin (), root.end (), 0);
+
+  for (P i = 0; i < vec.size (); ++i) if (vec.countries [i] == 0)
+
+    for (const auto& j : coin [i]) if (vec.countries [j] == 0) root [find (i)] = find (j);
+
+  for (P i = 0; i < vec.size (); ++i) if (vec.countries [i] == 0)
+    {
+      auto& r = near [find (i)];
+
+      for (const auto& j : coin [i])
+        {
+          if ((c = vec.countries [j]) != 0)
+            r.insert (c);
+        }
+    }
+
+  for (P i = 0; i < vec.size (); ++i) if (vec.countries [i] == 0) avail.insert (std::make_pair (i, near [find (i)]));
+  return avail;
+}
+
+/* Upset flags of participants already evaluated, keyed by a 64-bit
+ * fingerprint of the participant and of the countries held by the varying
+ * unknowns of its coincidence set (everything else stays put during a
+ * search, so the flag survives across configurations). Slots live in an
+ * open-addressing table sized once from a byte budget: probes stop after
+ * a small window and a full window evicts the home slot. Hashing a key
+ * walks the row much as evaluating it would, so this only pays off for
+ * long rows mostly made of varying unknowns, and --memo turns it on.
+ */
+template<typename C, typename P> class Memorizer
+{
+private:
+
+  static const std::size_t window = 8;
+
+  std::vector<std::uint64_t> slots;
+  std::vector<P> loose;
+  std::vector<std::size_t> offsets;
+  std::size_t mask;
+  std::uint64_t evictions = 0, hits = 0, misses = 0;
+
+  static inline std::uint64_t mix (std::uint64_t x)
+    {
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+      return x ^ (x >> 31);
+    }
+
+  static inline std::size_t home (std::uint64_t key)
+    {
+      return key >> 2;
+    }
+
+public:
+
+  /* A zero budget builds nothing, for a search that will not memoize */
+  inline Memorizer (const Coincidence<P>& coin, const std::vector<P>& varying, std::size_t budget) : mask (0)
+    {
+      if (budget == 0)
+
+        return;
+
+      std::vector<bool> vary (coin.size (), false);
+
+      for (const auto& k : varying) vary [k] = true;
+
+      offsets.reserve (coin.size () + 1);
+      offsets.push_back (0);
+
+      for (P p = 0; p < coin.size (); ++p)
+        {
+          for (const auto& j : coin [p]) if (vary [j]) loose.push_back (j);
+          offsets.push_back (loose.size ());
+        }
+
+      auto n = std::bit_floor (std::max (budget / sizeof (std::uint64_t), 2 * window));
+
+      slots.assign (n, 0);
+      mask = n - 1;
+    }
+
+  inline constexpr std::uint64_t get_evictions () const { return evictions; }
+  inline constexpr std::uint64_t get_hits () const { return hits; }
+  inline constexpr std::uint64_t get_misses () const { return misses; }
+
+  /* Bit 0 of a slot holds the flag and bit 1 is always set, so no key is
+   * ever mistaken for an empty slot.
+   */
+  inline std::uint64_t key (const Participants<C, P>& vec, P p) const
+    {
+      auto h = mix (1 + (std::uint64_t) p);
+
+      for (auto i = offsets [p]; i < offsets [p + 1]; ++i) h = mix (h ^ (std::uint64_t) vec.countries [loose [i]]);
+      return (h | 2) & ~std::uint64_t (1);
+    }
+
+  inline bool find (std::uint64_t key, bool* value)
+    {
+      for (std::size_t w = 0; w < window; ++w)
+        {
+          auto slot = slots [(home (key) + w) & mask];
+
+          if (slot == 0)
+            break;
+          else if ((slot & ~std::uint64_t (1)) == key)
+            return (*value = (slot & 1) == 1, ++hits, true);
+        }
+
+      return (++misses, false);
+    }
+
+  inline void insert (std::uint64_t key, bool value)
+    {
+      for (std::size_t w = 0; w < window; ++w)
+        {
+          auto& slot = slots [(home (key) + w) & mask];
+
+          if (slot == 0 || (slot & ~std::uint64_t (1)) == key)
+
+            return (void) (slot = key | value);
+        }
+
+      slots [home (key) & mask] = key | value;
+      ++evictions;
+    }
+};
+
+/* Whether the running CPU has AVX2, asked once */
+static inline bool avx2 ()
+{
+#if defined (CONFERENCE_X86)
+  static const bool has = __builtin_cpu_supports ("avx2");
+  return has;
+#else
+  return false;
+#endif
+}
+
+#if defined (CONFERENCE_X86)
+
+/* Whether wide [j] == k for every j in [at, end), eight per step: the
+ * (widened) countries are gathered straight through the CSR row. Takes
+ * plain pointers only, since nothing is inlined across the target switch.
+ */
+template<typename P> __attribute__ ((target ("avx2"))) inline bool row_avx2 (const std::uint32_t* wide, const P* at, const P* end, std::uint32_t k)
+{
+  auto c = _mm256_set1_epi32 ((int) k);
+
+  for (; at + 8 <= end; at += 8)
+    {
+      auto idx = _mm256_loadu_si256 ((const __m256i*) at);
+      auto got = _mm256_i32gather_epi32 ((const int*) wide, idx, sizeof (std::uint32_t));
+
+      if (_mm256_movemask_epi8 (_mm256_cmpeq_epi32 (got, c)) != -1)
+        return false;
+    }
+
+  for (; at != end; ++at) if (wide [*at] != k)
+    return false;
+  return true;
+}
+
+#endif // CONFERENCE_X86
+
+/* Upset flags of a whole configuration in one pass over the coincidence
+ * rows, flags [p] telling whether all of C_p holds p's country. Countries
+ * are widened into `wide` first, as AVX2 gathers load 32 bit lanes. Every
+ * row is probed on its first members one by one, where most of them
+ * break; the rest of a long row goes to the vector kernel whenever the
+ * CPU has it.
+ */
+template<typename C, typename P> inline P upset_flags (const Participants<C, P>& vec, const Coincidence<P>& coin, std::vector<std::uint32_t>& wide, std::vector<std::uint8_t>& flags)
+{
+  constexpr std::size_t probe = 8;
+
+  P upset = 0;
+  auto vector = sizeof (P) == sizeof (std::uint32_t) && avx2 ();
+
+  wide.assign (vec.countries.begin (), vec.countries.end ());
+  flags.resize (vec.size ());
+
+  for (P p = 0; p < vec.size (); ++p)
+    {
+      auto row = coin [p];
+      auto at = row.data (), end = row.data () + row.size ();
+      auto head = row.size () > probe && vector ? at + probe : end;
+      auto k = wide [p];
+      auto f = true;
+
+      for (; at != head; ++at) if (wide [*at] != k) { f = false; break; }
+
+#if defined (CONFERENCE_X86)
+      if (f == true && at != end) f = row_avx2 (wide.data (), at, end, k);
+#endif
+
+      upset += (flags [p] = f ? 1 : 0);
+    }
+
+  return upset;
+}
+
+template<typename C, typename P> inline P upset_count (const Participants<C, P>& vec, const Coincidence<P>& coin, Memorizer<C, P>* memo = nullptr)
+{
+  P upset = 0;
+
+  if (memo == nullptr)
+    {
+      std::vector<std::uint32_t> wide;
+      std::vector<std::uint8_t> flags;
+      return upset_flags (vec, coin, wide, flags);
+    }
+
+  for (P i = 0; i < vec.size (); ++i)
+    {
+      auto c = vec.countries [i];
+      auto f = true;
+      auto key = memo->key (vec, i);
+
+      if (memo->find (key, &f) == false)
+        {
+          for (const auto& j : coin [i])
+            {
+              auto k = vec.countries [j];
+              if (c != k) { f = false; break; }
+            }
+
+          memo->insert (key, f);
+        }
+
+      if (f == true) ++upset;
+    }
+
+  return upset;
+}
+
+/* upset_count straight from an interval tree of participant indices: each
+ * query stops at the first coinciding participant from another country,
+ * without ever materializing the coincidence sets.
+ */
+template<typename C, typename P, typename TTree> inline P upset_tree (const Participants<C, P>& vec, const TTree& tree)
+{
+  P upset = 0;
+
+  for (P p = 0; p < vec.size (); ++p)
+    {
+      auto c = vec.countries [p];
+      auto e = vec.ends [p];
+      auto s = vec.starts [p];
+
+      if (tree.any (s, e, [&vec, c](P j) { return vec.countries [j] != c; }) == false) ++upset;
+    }
+
+  return upset;
+}
+
+/* upset_count for participants whose countries are all known, in
+ * O(n log n) time and O(n) memory however much they overlap: days are cut
+ * into runs over which the same participants stay, a run is mixed when
+ * those hold more than one country, and p (there all along [s, e]) is
+ * upset exactly when no run in there is mixed, which is a difference of
+ * prefix counts.
+ */
+template<typename C, typename P> inline P upset_known (const Participants<C, P>& vec, std::vector<std::uint8_t>* flags = nullptr)
+{
+  using Day = std::uint64_t;
+
+  P upset = 0;
+  std::size_t distinct = 0;
+  std::vector<Day> cuts;
+  std::vector<P> mixed (1, 0);
+  std::vector<C> ranks (vec.countries);
+  std::vector<std::tuple<Day, P, bool>> events;
+
+  // Countries count by rank among those present, whatever C can hold
+  std::sort (ranks.begin (), ranks.end ());
+  ranks.erase (std::unique (ranks.begin (), ranks.end ()), ranks.end ());
+
+  std::vector<P> present (ranks.size (), 0);
+  auto rank = [&ranks](C c) { return (P) (std::lower_bound (ranks.begin (), ranks.end (), c) - ranks.begin ()); };
+
+  events.reserve (2 * vec.size ());
+
+  for (P p = 0; p < vec.size (); ++p)
+    {
+      auto c = rank (vec.countries [p]);
+
+      events.push_back (std::make_tuple ((Day) vec.starts [p], c, true));
+      events.push_back (std::make_tuple (1 + (Day) vec.ends [p], c, false));
+    }
+
+  std::sort (events.begin (), events.end (), [](const auto& a, const auto& b) { return std::get<0> (a) < std::get<0> (b); });
+
+  for (std::size_t i = 0; i < events.size ();)
+    {
+      auto at = std::get<0> (events [i]);
+
+      for (; i < events.size () && std::get<0> (events [i]) == at; ++i)
+        {
+          auto [_, c, arrives] = events [i];
+
+          if (arrives == true && present [c]++ == 0) ++distinct;
+          else if (arrives == false && --present [c] == 0) --distinct;
+        }
+
+      // mixed [j + 1] counts the mixed runs among the first j + 1
+      (cuts.push_back (at), mixed.push_back (mixed.back () + (distinct > 1 ? 1 : 0)));
+    }
+
+  if (flags != nullptr) flags->resize (vec.size ());
+
+  for (P p = 0; p < vec.size (); ++p)
+    {
+      auto a = std::lower_bound (cuts.begin (), cuts.end (), (Day) vec.starts [p]) - cuts.begin ();
+      auto b = std::lower_bound (cuts.begin (), cuts.end (), 1 + (Day) vec.ends [p]) - cuts.begin ();
+      auto f = mixed [b] == mixed [a];
+
+      if (flags != nullptr) (*flags) [p] = f ? 1 : 0;
+      if (f == true) ++upset;
+    }
+
+  return upset;
+}
+
+/* Unknowns with the same candidates and the same C (each lying in the
+ * other's, then) may as well hold the same country: while two of them
+ * differ nobody around them is upset, so handing one the other's country
+ * loses nothing. Groups such twins, first member leading, so searches
+ * only branch on the leaders and copy their country to the rest.
+ */
+template<typename C, typename P> inline std::vector<std::vector<P>> twins (const Coincidence<P>& coin, const std::map<P, std::set<C>>& avail)
+{
+  std::vector<std::vector<P>> groups;
+  std::map<std::uint64_t, std::vector<std::size_t>> seen;
+
+  for (const auto& [k, set] : avail)
+    {
+      std::uint64_t h = coin [k].size ();
+
+      for (const auto& j : coin [k]) h = h * 0x9e3779b97f4a7c15 + j;
+      for (const auto& c : set) h = h * 0x9e3779b97f4a7c15 + c;
+
+      auto& bucket = seen [h];
+      auto same = std::find_if (bucket.begin (), bucket.end (), [&](std::size_t g)
+        {
+          auto l = groups [g] [0];
+          return std::ranges::equal (coin [l], coin [k]) && avail.at (l) == set;
+        });
+
+      if (same != bucket.end ())
+        groups [*same].push_back (k);
+      else
+        (bucket.push_back (groups.size ()), groups.push_back (std::vector<P> { k }));
+    }
+
+  return groups;
+}
+
+/* Product space of the unknowns' candidate countries, one digit per group
+ * of twins. Unknowns with a single candidate are left out of it and
+ * pinned once instead.
+ */
+template<typename C, typename P> class Space
+{
+public:
+
+  std::vector<P> idxs;
+  std::vector<std::vector<C>> sets;
+  std::vector<std::vector<P>> members;
+  std::vector<std::pair<P, C>> pinned;
+
+  inline Space (const std::map<P, std::set<C>>& avail, const Coincidence<P>& coin)
+    {
+      for (auto& group : twins (coin, avail))
+        {
+          auto k = group [0];
+          auto& r = avail.at (k);
+
+          if (r.size () == 1)
+
+            for (const auto& m : group) pinned.push_back (std::make_pair (m, *r.begin ()));
+          else
+            {
+              idxs.push_back (k);
+              sets.push_back (std::vector<C> (r.begin (), r.end ()));
+              members.push_back (std::move (group));
+            }
+        }
+    }
+
+  inline constexpr std::size_t size () const { return idxs.size (); }
+
+  /* Every unknown whose country changes along the space */
+  inline std::vector<P> varying () const
+    {
+      std::vector<P> all;
+
+      for (const auto& group : members) all.insert (all.end (), group.begin (), group.end ());
+      return all;
+    }
+
+  /* Gives digit i's group the country c */
+  inline void set (Participants<C, P>& vec, std::size_t i, C c) const
+    {
+      for (const auto& m : members [i]) vec.countries [m] = c;
+    }
+
+  /* Sets pinned unknowns and every other one to its first candidate */
+  inline void pin (Participants<C, P>& vec) const
+    {
+      for (const auto& e : pinned) vec.countries [std::get<0> (e)] = std::get<1> (e);
+      for (std::size_t i = 0; i < size (); ++i) set (vec, i, sets [i] [0]);
+    }
+
+  /* Assignments of the unknowns from `fixed` on, or `cap` if that is less */
+  inline std::size_t configs (std::size_t fixed, std::size_t cap) const
+    {
+      std::size_t n = 1;
+
+      for (auto d = fixed; d < size () && n < cap; ++d) n *= sets [d].size ();
+      return std::min (n, cap);
+    }
+
+  /* Length of the shortest prefix splitting the space in at least n parts */
+  inline std::size_t split (std::size_t n) const
+    {
+      std::size_t d = 0;
+
+      for (std::size_t parts = 1; d < size () && parts < n; ++d) parts *= sets [d].size ();
+      return d;
+    }
+
+  /* Calls f (digits) for each assignment of the first `depth` unknowns */
+  template<typename F> inline void prefixes (std::size_t depth, F&& f) const
+    {
+      std::vector<std::size_t> digits (depth, 0);
+
+      while (true)
+        {
+          f (const_cast<const std::vector<std::size_t>&> (digits));
+
+          std::size_t i = depth;
+
+          for (; i > 0; --i) if (++digits [i - 1] < sets [i - 1].size ())
+            break;
+          else
+            digits [i - 1] = 0;
+
+          if (i == 0)
+
+            return;
+        }
+    }
+};
+
+/* Runs engine (vec, depth) once per prefix of the space as pool tasks,
+ * each on its own copy of `vec` with that prefix already assigned; the
+ * countries of the copy scoring best end up back in `vec`. Tasks falling
+ * short of the best count so far turn away without taking the lock.
+ */
+template<typename C, typename P, typename F> inline P fanout (Participants<C, P>& vec, const Space<C, P>& space, WorkPool* pool, F&& engine)
+{
+  std::atomic<P> best = 0;
+  std::mutex lock;
+  std::vector<C> won;
+  auto depth = space.split (8 * pool->size ());
+  auto group = TaskGroup (pool);
+
+  space.prefixes (depth, [&](const std::vector<std::size_t>& digits)
+    {
+      group.spawn ([&, digits] ()
+        {
+          auto local = vec;
+
+          for (std::size_t i = 0; i < depth; ++i) space.set (local, i, space.sets [i] [digits [i]]);
+
+          auto b = engine (local, depth);
+
+          if (b < best.load (std::memory_order_relaxed))
+
+            return;
+
+          auto guard = std::lock_guard<std::mutex> (lock);
+
+          if (b > best || won.size () == 0) (best = b, won = std::move (local.countries));
+        });
+    });
+
+  group.wait ();
+  return (vec.countries = std::move (won), best.load ());
+}
+
+/* Odometer over the unknowns from `fixed` on, recounting every configuration
+ * (with upset_flags, or through the Memorizer when --memo gives it a budget,
+ * unless a single configuration leaves nothing to repeat).
+ * Digits are copied aside only when the count improves, and the best ones
+ * are left in `vec` on return.
+ */
+template<typename C, typename P> inline P enumerate (Participants<C, P>& vec, const Coincidence<P>& coin, const Space<C, P>& space, std::size_t fixed, std::size_t budget, Stats* stats = nullptr, const Deadline* deadline = nullptr)
+{
+  P b, best = 0;
+  std::uint64_t visited = 0;
+  // Nothing repeats with no digit left to turn, and no more keys than one
+  // per participant and configuration are ever stored (at half load)
+  auto limit = fixed == space.size () || coin.size () == 0 ? 0 : budget / sizeof (std::uint64_t);
+  auto keys = limit == 0 ? 0 : coin.size () * space.configs (fixed, limit / coin.size () + 1);
+  auto memo = Memorizer<C, P> (coin, space.varying (), std::min (limit, 2 * keys) * sizeof (std::uint64_t));
+  std::vector<std::size_t> digits (space.size (), 0), won (space.size (), 0);
+  std::vector<std::uint32_t> wide;
+  std::vector<std::uint8_t> flags;
+
+  auto done = [&] ()
+    {
+      for (std::size_t i = fixed; i < space.size (); ++i) space.set (vec, i, space.sets [i] [won [i]]);
+      if (stats != nullptr) (stats->configs += visited, stats->hits += memo.get_hits (), stats->misses += memo.get_misses (), stats->evictions += memo.get_evictions ());
+      return best;
+    };
+
+  while (true)
+    {
+      if (++visited % Deadline::stride == 0 && deadline != nullptr && deadline->passed ())
+
+        return done ();
+
+      for (std::size_t i = fixed; i < space.size (); ++i)
+
+        space.set (vec, i, space.sets [i] [digits [i]]);
+
+      if ((b = limit == 0 ? upset_flags (vec, coin, wide, flags) : upset_count (vec, coin, &memo)) > best)
+        (best = b, won = digits);
+
+      for (std::size_t i = space.size (); i > fixed; --i)
+        {
+          if (++digits [i - 1] != space.sets [i - 1].size ())
+            break;
+          else if (i - 1 == fixed)
+            return done ();
+          else
+            digits [i - 1] = 0;
+        }
+
+      if (fixed == space.size ())
+
+        return done ();
+    }
+}
+
+template<typename C, typename P> inline P optimize (Participants<C, P>& vec, const Coincidence<P>& coin, std::map<P, std::set<C>>&& avail, WorkPool* pool = nullptr, std::size_t budget = 0, Stats* stats = nullptr, const Deadline* deadline = nullptr)
+{
+  auto space = Space<C, P> (avail, coin);
+
+  space.pin (vec);
+
+  if (pool == nullptr)
+
+    return enumerate (vec, coin, space, 0, budget, stats, deadline);
+  else
+    return fanout (vec, space, pool, [&](auto& local, std::size_t fixed) { return enumerate (local, coin, space, fixed, budget, stats, deadline); });
+}
+
+/* Running upset count of a country assignment: mismatch [p] counts the
+ * members of C_p whose country differs from p's, so p is upset exactly
+ * when it is zero and changing one country only touches one row.
+ */
+template<typename C, typename P> class UpsetDelta
+{
+private:
+
+  Participants<C, P>& vec;
+  const Coincidence<P>& coin;
+  std::vector<P> mismatch;
+  P upset = 0;
+
+public:
+
+  inline UpsetDelta (Participants<C, P>& vec, const Coincidence<P>& coin) : vec (vec), coin (coin), mismatch (vec.size (), 0)
+    {
+      for (P p = 0; p < vec.size (); ++p)
+        {
+          auto c = vec.countries [p];
+
+          for (const auto& q : coin [p]) if (vec.countries [q] != c) ++mismatch [p];
+          if (mismatch [p] == 0) ++upset;
+        }
+    }
+
+  inline constexpr P get_upset () const { return upset; }
+
+  inline void assign (P k, C b)
+    {
+      auto a = vec.countries [k];
+      P m = 0;
+
+      if (a == b)
+
+        return;
+
+      for (const auto& q : coin [k]) if (q != k)
+        {
+          auto c = vec.countries [q];
+          auto& x = mismatch [q];
+
+          if (c != b) ++m;
+
+          if (a == c && x++ == 0) --upset;
+          else if (b == c && --x == 0) ++upset;
+        }
+
+      if (mismatch [k] == 0) --upset;
+      if ((mismatch [k] = m) == 0) ++upset;
+
+      vec.countries [k] = b;
+    }
+};
+
+/* Walks the unknowns from `fixed` on in reflected mixed-radix Gray order:
+ * every step changes a single country and re-evaluates only the
+ * participants coinciding with it. As in enumerate, the best digits are
+ * left in `vec`.
+ */
+template<typename C, typename P> inline P gray (Participants<C, P>& vec, const Coincidence<P>& coin, const Space<C, P>& space, std::size_t fixed, Stats* stats = nullptr, const Deadline* deadline = nullptr)
+{
+  std::uint64_t visited = 1;
+  auto delta = UpsetDelta<C, P> (vec, coin);
+  auto best = delta.get_upset ();
+  std::vector<std::size_t> digits (space.size (), 0), won (space.size (), 0);
+  std::vector<bool> up (space.size (), true);
+
+  while (true)
+    {
+      std::size_t i = space.size ();
+
+      for (; i > fixed; --i)
+        {
+          auto j = i - 1;
+
+          if (up [j] ? digits [j] + 1 < space.sets [j].size () : digits [j] > 0)
+            break;
+          else
+            up [j] = ! up [j];
+        }
+
+      if (i == fixed || (++visited % Deadline::stride == 0 && deadline != nullptr && deadline->passed ()))
+        {
+          for (auto k = fixed; k < space.size (); ++k) space.set (vec, k, space.sets [k] [won [k]]);
+          return ((stats != nullptr ? (void) (stats->configs += visited) : (void) 0), best);
+        }
+
+      auto j = i - 1;
+
+      digits [j] = up [j] ? digits [j] + 1 : digits [j] - 1;
+      for (const auto& m : space.members [j]) delta.assign (m, space.sets [j] [digits [j]]);
+      if (delta.get_upset () > best) (best = delta.get_upset (), won = digits);
+    }
+}
+
+/* Same search space as optimize, incrementally evaluated */
+template<typename C, typename P> inline P optimize_delta (Participants<C, P>& vec, const Coincidence<P>& coin, std::map<P, std::set<C>>&& avail, WorkPool* pool = nullptr, Stats* stats = nullptr, const Deadline* deadline = nullptr)
+{
+  auto space = Space<C, P> (avail, coin);
+
+  space.pin (vec);
+
+  if (pool == nullptr)
+
+    return gray (vec, coin, space, 0, stats, deadline);
+  else
+    return fanout (vec, space, pool, [&](auto& local, std::size_t fixed) { return gray (local, coin, space, fixed, stats, deadline); });
+}
+
+/* Exact search assigning one unknown at a time. Every participant p has a
+ * colour, the only country C_p may hold for p to be upset (its own for
+ * known participants, the single known country around it for unknowns),
+ * and `dead [p]` counts assigned members breaking it; live participants,
+ * minus those doomed whatever comes next, bound what a branch can reach.
+ * Unknowns meeting no known country are `loose`: their colour is whatever
+ * the first member of C_p assigned takes, and `agree [p]` counts those
+ * holding it.
+ */
+template<typename C, typename P> class BranchBound
+{
+private:
+
+  const Coincidence<P>& coin;
+  std::vector<P> idxs;
+  std::vector<std::vector<C>> sets;
+  std::vector<std::vector<P>> members;
+  std::vector<C> colour;
+  std::vector<P> dead, agree;
+  std::vector<std::uint8_t> loose;
+  std::vector<C> assignment, current;
+  std::vector<std::size_t> claim;
+  std::vector<std::pair<P, C>> classes;
+  std::size_t stamp = 0;
+  std::uint64_t visited = 0;
+  const Deadline* deadline;
+  P alive = 0, best = 0;
+  bool found = false, cut = false;
+
+  /* Assignments are taken back in reverse, so a loose colour stays put
+   * until the one that set it is gone
+   */
+  inline void assign (P k, C c, int by)
+    {
+      for (const auto& p : coin [k])
+        {
+          if (by > 0 && free (p)) colour [p] = c;
+
+          if (colour [p] == c)
+            agree [p] += by;
+          else if (by > 0 && dead [p]++ == 0)
+            --alive;
+          else if (by < 0 && --dead [p] == 0)
+            ++alive;
+        }
+    }
+
+  /* Loose and still without a colour, so whatever comes suits it */
+  inline bool free (P p) const
+    {
+      return loose [p] != 0 && agree [p] == 0 && dead [p] == 0;
+    }
+
+  /* Live members of C_k grouped by colour, largest group first, leaving
+   * out those claimed at stamp `at` (if not zero)
+   */
+  inline P group (P k, std::size_t at)
+    {
+      P total = 0;
+
+      classes.clear ();
+
+      for (const auto& p : coin [k]) if (dead [p] == 0 && free (p) == false && (at == 0 || claim [p] != at))
+        {
+          auto iter = std::find_if (classes.begin (), classes.end (), [&](const auto& e) { return std::get<1> (e) == colour [p]; });
+
+          if (iter == classes.end ())
+            classes.push_back (std::make_pair (1, colour [p]));
+          else
+            ++std::get<0> (*iter);
+          ++total;
+        }
+
+      std::sort (classes.begin (), classes.end (), [](const auto& a, const auto& b) { return std::get<0> (a) > std::get<0> (b); });
+      return total;
+    }
+
+  /* Whatever an unassigned unknown takes, at most one colour group around
+   * it survives. Charging each live participant to one unknown only keeps
+   * the losses disjoint, so they add up.
+   */
+  inline P doomed (std::size_t depth)
+    {
+      P n = 0;
+      auto at = ++stamp;
+
+      for (auto i = depth; i < idxs.size (); ++i)
+        {
+          auto k = idxs [i];
+          auto total = group (k, at);
+
+          if (classes.size () > 1)
+            {
+              n += total - std::get<0> (classes [0]);
+              for (const auto& p : coin [k]) if (dead [p] == 0) claim [p] = at;
+            }
+        }
+
+      return n;
+    }
+
+  void descend (std::size_t depth)
+    {
+      if (cut == true || (++visited % Deadline::stride == 0 && deadline != nullptr && (cut = deadline->passed ())))
+
+        return;
+
+      if (depth == idxs.size ())
+        {
+          if (alive > best || found == false)
+
+            (best = alive, assignment = current, found = true);
+          return;
+        }
+
+      if (found == true && alive - doomed (depth) <= best)
+
+        return;
+
+      auto k = idxs [depth];
+      auto total = group (k, 0);
+      std::vector<std::pair<P, C>> order;
+
+      for (const auto& e : classes) if (std::binary_search (sets [depth].begin (), sets [depth].end (), std::get<1> (e)))
+        order.push_back (std::make_pair (total - std::get<0> (e), std::get<1> (e)));
+
+      // A country nobody live around k holds kills them all, as any other,
+      // unless it also gives colourless loose ones around k their colour
+      if (std::any_of (coin [k].begin (), coin [k].end (), [this](P p) { return free (p); }))
+        {
+          for (const auto& c : sets [depth]) if (std::none_of (order.begin (), order.end (), [c](const auto& o) { return std::get<1> (o) == c; }))
+            order.push_back (std::make_pair (total, c));
+        }
+      else if (order.size () == 0)
+
+        order.push_back (std::make_pair (total, sets [depth] [0]));
+
+      for (const auto& o : order)
+        {
+          if (found == true && alive - std::get<0> (o) <= best)
+            break;
+
+          auto c = std::get<1> (o);
+
+          current [depth] = c;
+          for (const auto& m : members [depth]) assign (m, c, 1);
+          descend (1 + depth);
+          for (const auto& m : members [depth]) assign (m, c, -1);
+        }
+    }
+
+public:
+
+  inline BranchBound (const Participants<C, P>& vec, const Coincidence<P>& coin, const std::map<P, std::set<C>>& avail, const Deadline* deadline = nullptr)
+    : coin (coin), colour (vec.size (), 0), dead (vec.size (), 0), agree (vec.size (), 0), loose (vec.size (), 0), claim (vec.size (), 0), deadline (deadline)
+    {
+      std::vector<const std::vector<C>*> domain (vec.size (), nullptr);
+
+      // Twins move together, as in Space
+      for (auto& group : twins (coin, avail))
+        {
+          auto& r = avail.at (group [0]);
+
+          idxs.push_back (group [0]);
+          sets.push_back (std::vector<C> (r.begin (), r.end ()));
+          members.push_back (std::move (group));
+        }
+
+      for (std::size_t i = 0; i < idxs.size (); ++i) for (const auto& m : members [i]) domain [m] = & sets [i];
+
+      for (P p = 0; p < vec.size (); ++p)
+        {
+          auto c = vec.countries [p];
+          auto f = true;
+
+          for (const auto& q : coin [p]) if (auto k = vec.countries [q]; k != 0)
+            {
+              if (c == 0) c = k;
+              else if (c != k) f = false;
+            }
+
+          // Unknowns unable to take the colour doom p from the start
+          for (const auto& q : coin [p]) if (auto d = domain [q]; f == true && c != 0 && d != nullptr)
+            f = std::binary_search (d->begin (), d->end (), c);
+
+          colour [p] = c;
+          loose [p] = c == 0 ? 1 : 0;
+          dead [p] = f ? 0 : 1;
+          alive += f ? 1 : 0;
+        }
+
+      current.resize (idxs.size ());
+    }
+
+  inline P solve ()
+    {
+      return (descend (0), best);
+    }
+
+  /* Prunes against an upset count known to be reachable; only strictly
+   * better assignments are recorded from then on
+   */
+  inline void seed (P bound)
+    {
+      (best = bound, found = true);
+    }
+
+  inline constexpr P get_best () const { return best; }
+  inline constexpr std::uint64_t get_visited () const { return visited; }
+
+  /* Writes the best assignment found so far into `vec` */
+  inline void apply (Participants<C, P>& vec) const
+    {
+      for (std::size_t i = 0; i < assignment.size (); ++i) for (const auto& m : members [i]) vec.countries [m] = assignment [i];
+    }
+};
+
+template<typename C, typename P> inline P branch_bound (Participants<C, P>& vec, const Coincidence<P>& coin, std::map<P, std::set<C>>&& avail, Stats* stats = nullptr, const Deadline* deadline = nullptr, P floor = 0)
+{
+  auto search = BranchBound<C, P> (vec, coin, avail, deadline);
+
+  if (floor > 0) search.seed (floor);
+
+  auto best = search.solve ();
+
+  if (stats != nullptr) stats->configs += search.get_visited ();
+  return (search.apply (vec), best);
+}
+
+/* Exact search sweeping the participants by day, each departure after the
+ * arrivals of its last day. Whoever is active meets everyone else active,
+ * so two countries among them doom them all, and otherwise the pure ones
+ * (having met only their own country) are the latest arrivals: a state is
+ * the countries of the active unknowns plus how many arrivals are still
+ * pure, and the states kept grow with the candidates of the unknowns
+ * active at once, not with those of every unknown.
+ */
+template<typename C, typename P> class SweepDP
+{
+private:
+
+  struct Key
+    {
+      std::vector<C> unknowns;
+      P pure;
+
+      inline bool operator== (const Key& o) const = default;
+    };
+
+  struct Hash
+    {
+      inline std::size_t operator() (const Key& key) const
+        {
+          std::size_t h = key.pure;
+          for (const auto& c : key.unknowns) h = h * 0x9e3779b1 + c;
+          return h;
+        }
+    };
+
+  const Participants<C, P>& vec;
+  const std::map<P, std::set<C>>& avail;
+  std::vector<Key> keys;
+  std::vector<P> values;
+  std::vector<P> active;
+  std::map<C, P> known;
+
+  // Per step, the state each one came from and (arrivals of unknowns only)
+  // the country it gave the newcomer
+  std::vector<std::vector<std::uint32_t>> parents;
+  std::vector<std::pair<P, std::vector<C>>> picks;
+
+  std::uint64_t visited = 0;
+  const Deadline* deadline;
+  bool cut = false;
+
+  template<typename F> inline void step (P p, bool branch, F&& next)
+    {
+      std::unordered_map<Key, std::uint32_t, Hash> seen;
+      std::vector<Key> to;
+      std::vector<P> got;
+      std::vector<std::uint32_t> from;
+      std::vector<C> chose;
+
+      auto emit = [&](std::uint32_t i, Key&& key, P value, C c)
+        {
+          if (auto iter = seen.find (key); iter == seen.end ())
+            {
+              seen.emplace (key, (std::uint32_t) to.size ());
+              (to.push_back (std::move (key)), got.push_back (value), from.push_back (i), chose.push_back (c));
+            }
+          else if (auto j = iter->second; got [j] < value)
+
+            (got [j] = value, from [j] = i, chose [j] = c);
+        };
+
+      for (std::uint32_t i = 0; i < keys.size () && cut == false; ++i)
+        {
+          if (++visited % Deadline::stride == 0 && deadline != nullptr && (cut = deadline->passed ()))
+            break;
+
+          next (i, emit);
+        }
+
+      (keys = std::move (to), values = std::move (got));
+      parents.push_back (std::move (from));
+      picks.push_back (std::make_pair (p, branch ? std::move (chose) : std::vector<C> ()));
+    }
+
+  /* A newcomer meets whoever is active and ends at or past its arrival,
+   * which in order of end is a prefix: once a prefix mixes countries every
+   * longer one does, so the countries of unknowns from there on (blocks of
+   * equal end included) can never matter again and turn into a zero. That
+   * merges states differing only there, so a state keeps at most one
+   * country per active unknown that no other active country ends after.
+   */
+  inline void canonical (Key& key, const std::vector<std::pair<P, std::size_t>>& lanes) const
+    {
+      C uniform = 0;
+      bool mixed = false;
+
+      for (std::size_t i = 0, j; i < lanes.size (); i = j)
+        {
+          auto end = vec.ends [std::get<0> (lanes [i])];
+
+          for (j = i; j < lanes.size () && vec.ends [std::get<0> (lanes [j])] == end; ++j) if (mixed == false)
+            {
+              auto [p, slot] = lanes [j];
+              auto c = vec.countries [p] != 0 ? vec.countries [p] : key.unknowns [slot];
+
+              if (c == 0 || (uniform != 0 && c != uniform))
+                mixed = true;
+              else
+                uniform = c;
+            }
+
+          if (mixed == true) for (auto k = i; k < j; ++k) if (auto [p, slot] = lanes [k]; vec.countries [p] == 0)
+            key.unknowns [slot] = 0;
+        }
+    }
+
+  inline void arrive (P q)
+    {
+      auto c = vec.countries [q];
+      auto unknown = c == 0;
+      auto* set = unknown ? & avail.at (q) : nullptr;
+      std::vector<std::pair<P, std::size_t>> lanes;
+
+      // Active participants by latest end, with their slot among unknowns
+      for (std::size_t slot = 0; auto& p : active) lanes.push_back (std::make_pair (p, vec.countries [p] == 0 ? slot++ : 0));
+      lanes.push_back (std::make_pair (q, unknown ? std::count_if (active.begin (), active.end (), [&](P p) { return vec.countries [p] == 0; }) : 0));
+      std::stable_sort (lanes.begin (), lanes.end (), [&](const auto& a, const auto& b) { return vec.ends [std::get<0> (a)] > vec.ends [std::get<0> (b)]; });
+
+      step (q, unknown, [&](std::uint32_t i, auto& emit)
+        {
+          const auto& key = keys [i];
+
+          auto take = [&](C c)
+            {
+              auto share = (known.size () == 0 || (known.size () == 1 && known.begin ()->first == c))
+                && std::all_of (key.unknowns.begin (), key.unknowns.end (), [c](C k) { return k == c; });
+              auto next = Key { key.unknowns, share ? 1 + key.pure : 0 };
+
+              if (unknown == true) next.unknowns.push_back (c);
+              canonical (next, lanes);
+              emit (i, std::move (next), values [i], c);
+            };
+
+          if (unknown == false)
+            take (c);
+          else
+            for (const auto& k : *set) take (k);
+        });
+
+      active.push_back (q);
+      if (unknown == false) ++known [c];
+    }
+
+  inline void depart (P p)
+    {
+      auto pos = (std::size_t) (std::find (active.begin (), active.end (), p) - active.begin ());
+      auto rank = (P) (active.size () - 1 - pos);
+      auto slot = (std::size_t) std::count_if (active.begin (), active.begin () + pos, [&](P q) { return vec.countries [q] == 0; });
+      auto unknown = vec.countries [p] == 0;
+
+      step (p, false, [&](std::uint32_t i, auto& emit)
+        {
+          const auto& key = keys [i];
+          auto pure = rank < key.pure;
+          auto next = Key { key.unknowns, pure ? key.pure - 1 : key.pure };
+
+          if (unknown == true) next.unknowns.erase (next.unknowns.begin () + slot);
+          emit (i, std::move (next), values [i] + (pure ? 1 : 0), 0);
+        });
+
+      active.erase (active.begin () + pos);
+      if (unknown == false && --known [vec.countries [p]] == 0) known.erase (vec.countries [p]);
+    }
+
+public:
+
+  inline SweepDP (const Participants<C, P>& vec, const std::map<P, std::set<C>>& avail, const Deadline* deadline = nullptr)
+    : vec (vec), avail (avail), keys (1, Key { {}, 0 }), values (1, 0), deadline (deadline)
+    {
+    }
+
+  /* Participants come sorted by start; those ending before the next one
+   * starts leave first (by end), so nobody leaves ahead of someone it meets
+   */
+  inline P solve ()
+    {
+      std::vector<P> byend (vec.size ());
+
+      std::iota (byend.begin (), byend.end (), 0);
+      std::stable_sort (byend.begin (), byend.end (), [&](P a, P b) { return vec.ends [a] < vec.ends [b]; });
+
+      auto d = byend.begin ();
+
+      for (P q = 0; q < vec.size () && cut == false; ++q)
+        {
+          for (; d != byend.end () && vec.ends [*d] < vec.starts [q] && cut == false; ++d) depart (*d);
+          arrive (q);
+        }
+
+      for (; d != byend.end () && cut == false; ++d) depart (*d);
+      return cut ? 0 : values [0];
+    }
+
+  inline constexpr std::uint64_t get_visited () const { return visited; }
+
+  /* Writes the assignment reaching the count solve returned into `vec`,
+   * following the recorded parents back from the final state
+   */
+  inline void apply (Participants<C, P>& vec) const
+    {
+      if (cut == true || parents.size () == 0) return;
+
+      std::uint32_t at = 0;
+
+      for (auto i = parents.size (); i-- > 0;)
+        {
+          const auto& [p, chose] = picks [i];
+
+          if (chose.size () > 0) vec.countries [p] = chose [at];
+          at = parents [i] [at];
+        }
+    }
+};
+
+template<typename C, typename P> inline P sweep_dp (Participants<C, P>& vec, std::map<P, std::set<C>>&& avail, Stats* stats = nullptr, const Deadline* deadline = nullptr)
+{
+  auto search = SweepDP<C, P> (vec, avail, deadline);
+  auto best = search.solve ();
+
+  if (stats != nullptr) stats->configs += search.get_visited ();
+  return (search.apply (vec), best);
+}
+
+/* Reachable upset count for --budget-ms: every unknown takes the candidate
+ * most of its known neighbours hold, then two moves are kept while they
+ * raise the count (UpsetDelta prices each in O(|C_k|)), until neither does
+ * or the deadline passes: changing one unknown's country, and handing the
+ * colour of some p (as in BranchBound) to every unknown of C_p at once,
+ * which is what making p upset usually takes. Leaves the assignment in
+ * `vec`.
+ */
+template<typename C, typename P> inline P greedy (Participants<C, P>& vec, const Coincidence<P>& coin, const std::map<P, std::set<C>>& avail, const Deadline* deadline)
+{
+  std::map<C, P> votes;
+  std::vector<const std::set<C>*> domain (vec.size (), nullptr);
+  std::vector<C> colour (vec.size (), 0);
+  std::vector<std::pair<P, C>> undo;
+
+  for (const auto& [k, set] : avail) domain [k] = & set;
+
+  for (P p = 0; p < vec.size (); ++p)
+    {
+      auto c = vec.countries [p];
+
+      for (const auto& q : coin [p]) if (auto k = vec.countries [q]; k != 0 && c != k)
+        {
+          if (domain [p] == nullptr || c != 0) { c = 0; break; }
+          else c = k;
+        }
+
+      colour [p] = c;
+    }
+
+  for (const auto& [k, set] : avail) if (set.size () > 0)
+    {
+      C pick = *set.begin ();
+      P most = 0;
+
+      votes.clear ();
+
+      for (const auto& q : coin [k]) if (auto c = vec.countries [q]; c != 0 && set.contains (c)) ++votes [c];
+      for (const auto& [c, n] : votes) if (n > most) (pick = c, most = n);
+
+      vec.countries [k] = pick;
+    }
+
+  auto delta = UpsetDelta<C, P> (vec, coin);
+
+  for (bool better = true; better == true && (deadline == nullptr || deadline->passed () == false);)
+    {
+      better = false;
+
+      for (const auto& [k, set] : avail)
+        {
+          auto was = vec.countries [k];
+          auto pick = was;
+          auto best = delta.get_upset ();
+
+          for (const auto& c : set) if (c != was)
+            {
+              delta.assign (k, c);
+              if (delta.get_upset () > best) (best = delta.get_upset (), pick = c);
+            }
+
+          delta.assign (k, pick);
+          better = better || pick != was;
+        }
+
+      for (P p = 0; p < vec.size (); ++p) if (auto c = colour [p]; c != 0)
+        {
+          auto before = delta.get_upset ();
+          auto fits = std::all_of (coin [p].begin (), coin [p].end (), [&](P q) { return domain [q] == nullptr || domain [q]->contains (c); });
+
+          if (fits == false)
+
+            continue;
+
+          undo.clear ();
+
+          for (const auto& q : coin [p]) if (domain [q] != nullptr && vec.countries [q] != c)
+
+            (undo.push_back (std::make_pair (q, vec.countries [q])), delta.assign (q, c));
+
+          if (delta.get_upset () > before)
+            better = true;
+          else
+            for (auto iter = undo.rbegin (); iter != undo.rend (); ++iter) delta.assign (std::get<0> (*iter), std::get<1> (*iter));
+        }
+    }
+
+  return delta.get_upset ();
+}
+
+enum class Engine
+{
+  enumerate,
+  delta,
+  bnb,
+  dp,
+};
+
+struct Options
+{
+  Engine engine = Engine::bnb;
+  double budget = 0;
+  std::size_t memo = 0;
+  unsigned threads = 1;
+  bool dynamic = false;
+  bool stats = false;
+  bool timing = false;
+  bool witness = false;
+};
+
+/* What --witness prints for a case, by input position: the country every
+ * unknown ends up with (one for those cleanse drops, as any country held
+ * by a whole component upsets it whole) and the participants upset under
+ * it. Filled from the assignment
+ * the engines leave behind, after the search and never during it.
+ */
+template<typename C, typename P> struct Witness
+{
+  std::vector<std::pair<P, C>> countries;
+  std::vector<P> upset;
+
+  /* Takes the unknowns of vec (zero in `before`) and the flagged ones */
+  inline void record (const Participants<C, P>& vec, const std::vector<C>& before, const std::vector<std::uint8_t>& flags)
+    {
+      for (P p = 0; p < vec.size (); ++p)
+        {
+          if (before [p] == 0) countries.push_back (std::make_pair (vec.ids [p], vec.countries [p]));
+          if (flags [p] != 0) upset.push_back (vec.ids [p]);
+        }
+    }
+
+  inline void merge (Witness&& o)
+    {
+      countries.insert (countries.end (), o.countries.begin (), o.countries.end ());
+      upset.insert (upset.end (), o.upset.begin (), o.upset.end ());
+    }
+
+  inline void print (std::ostream& out, std::size_t i)
+    {
+      std::sort (countries.begin (), countries.end ());
+      std::sort (upset.begin (), upset.end ());
+
+      out << "case " << i << ": assigned";
+      for (const auto& [p, c] : countries) out << ' ' << p << ':' << (unsigned) c;
+      out << '\n' << "case " << i << ": upset";
+      for (const auto& p : upset) out << ' ' << p;
+      out << '\n';
+    }
+};
+
+/* Under a deadline, the greedy bound comes first and the exact engine then
+ * runs until done or cut short, whichever answer is larger winning.
+ */
+template<typename C, typename P> inline P search (Participants<C, P>& vec, const Coincidence<P>& coin, const Options& options, WorkPool* pool, Stats* stats, const Deadline* deadline)
+{
+  P floor = 0, best = 0;
+  auto avail = [&] () { auto phase = Stats::Phase (stats, &Stats::genavail); return genavail (vec, coin); } ();
+  auto phase = Stats::Phase (stats, &Stats::search);
+  auto guess = Participants<C, P> ();
+
+  if (stats != nullptr) stats->domain (avail);
+
+  // Engines expect unknowns at zero, so the guess goes on a copy
+  if (deadline != nullptr) (guess = vec, floor = greedy (guess, coin, avail, deadline));
+
+  switch (options.engine)
+    {
+      case Engine::enumerate: best = optimize (vec, coin, std::move (avail), pool, options.memo, stats, deadline); break;
+      case Engine::delta: best = optimize_delta (vec, coin, std::move (avail), pool, stats, deadline); break;
+      case Engine::dp: best = sweep_dp (vec, std::move (avail), stats, deadline); break;
+      default: best = branch_bound (vec, coin, std::move (avail), stats, deadline, floor); break;
+    }
+
+  if (deadline != nullptr && floor >= best) (vec = std::move (guess), best = floor);
+  return best;
+}
+
+/* Participants in different components never meet, so each one with
+ * unknowns is searched on its own (as a pool task, if any) and the upset
+ * counts add up: a product of search spaces becomes a sum.
+ */
+template<typename C, typename P> inline P decompose (Participants<C, P>& vec, const Options& options, WorkPool* pool, Stats* stats, const Deadline* deadline, Witness<C, P>* witness)
+{
+  P upset = 0;
+  auto runs = components (vec);
+  auto group = TaskGroup (pool);
+  std::vector<P> found (runs.size (), 0);
+  std::vector<Witness<C, P>> parts (witness != nullptr ? runs.size () : 0);
+
+  for (std::size_t i = 0; i < runs.size (); ++i)
+    {
+      auto begin = std::get<0> (runs [i]);
+      auto end = std::get<1> (runs [i]);
+      auto zeros = std::any_of (vec.countries.begin () + begin, vec.countries.begin () + end, [](C c) { return c == 0; });
+
+      auto solve = [&, i, begin, end, zeros] ()
+        {
+          auto part = vec.slice (begin, end);
+          auto before = witness != nullptr ? part.countries : std::vector<C> ();
+          std::vector<std::uint8_t> flags;
+
+          if (zeros == true)
+            {
+              auto coin = [&] () { auto phase = Stats::Phase (stats, &Stats::index); return Coincidence<P>::sweep (part); } ();
+              std::vector<std::uint32_t> wide;
+
+              if (stats != nullptr) stats->swept (coin);
+
+              found [i] = search (part, coin, options, pool, stats, deadline);
+              if (witness != nullptr) upset_flags (part, coin, wide, flags);
+            }
+          else
+            {
+              auto phase = Stats::Phase (stats, &Stats::count);
+              found [i] = upset_known (part, witness != nullptr ? &flags : nullptr);
+            }
+
+          if (witness != nullptr) parts [i].record (part, before, flags);
+        };
+
+      if (zeros == false)
+        solve ();
+      else
+        group.spawn (std::move (solve));
+    }
+
+  group.wait ();
+
+  for (auto& part : parts) witness->merge (std::move (part));
+  for (const auto& n : found) upset += n;
+  return upset;
+}
+
+template<typename C, typename P> inline P solve (Participants<C, P>&& vec, Coincidence<P>&& coin, const Options& options, WorkPool* pool, Stats* stats = nullptr, const Deadline* deadline = nullptr, Witness<C, P>* witness = nullptr)
+{
+  P upset = 0;
+  P zeros = 0;
+  std::vector<P> dropped;
+
+  // Every country known by now: a single pass, flags kept for the witness
+  auto count = [&] ()
+    {
+      auto phase = Stats::Phase (stats, &Stats::count);
+
+      if (witness == nullptr)
+        return upset_count (vec, coin);
+      else
+        {
+          std::vector<std::uint32_t> wide;
+          std::vector<std::uint8_t> flags;
+          auto n = upset_flags (vec, coin, wide, flags);
+
+          return (witness->record (vec, vec.countries, flags), n);
+        }
+    };
+
+  for (const auto& c : vec.countries) if (c == 0) ++zeros;
+
+  if (zeros == 0)
+
+    upset = count ();
+  else
+    {
+      zeros = 0;
+
+      {
+        auto phase = Stats::Phase (stats, &Stats::cleanse);
+        vec = cleanse (std::move (vec), coin, &upset, &zeros, witness != nullptr ? &dropped : nullptr);
+      }
+
+      if (stats != nullptr) stats->useless += upset;
+
+      for (const auto& p : dropped) (witness->countries.push_back (std::make_pair (p, C (1))), witness->upset.push_back (p));
+
+      if (zeros == 0)
+        upset += count ();
+      else
+        upset += decompose (vec, options, pool, stats, deadline, witness);
+    }
+
+  return upset;
+}
+
+/* Interval tree variants of the coincidence sets, kept to compare layouts */
+template<typename TTree, typename P> inline TTree plant (std::vector<P>&& points)
+{
+  if constexpr (std::is_constructible_v<TTree, std::vector<P>&&>)
+
+    return TTree (std::move (points));
+  else
+    return TTree (0, *std::max_element (points.begin (), points.end ()));
+}
+
+template<typename C, typename P, typename TTree> inline TTree index (const Participants<C, P>& vec)
+{
+  P i = 0;
+  std::vector<P> points;
+
+  points.reserve (2 * vec.size ());
+
+  for (P p = 0; p < vec.size (); ++p) (points.push_back (vec.starts [p]), points.push_back (vec.ends [p]));
+
+  auto tree = plant<TTree> (std::move (points));
+
+  for (; i < vec.size (); ++i)
+    {
+      auto e = vec.ends [i];
+      auto s = vec.starts [i];
+
+      tree.insert (s, e, P (i));
+    }
+
+  return tree;
+}
+
+template<typename C, typename P, typename TTree> inline Coincidence<P> coincide (const Participants<C, P>& vec)
+{
+  if (vec.size () == 0)
+
+    return Coincidence<P> ();
+  else
+    return Coincidence<P>::lookup (vec, index<C, P, TTree> (vec));
+}
+
+/* Extracts an integer through a wide one (an std::uint8_t country would
+ * otherwise read as a character), failing the stream if it does not fit
+ */
+template<typename T> inline std::istream& read (std::istream& in, T& x)
+{
+  unsigned long long wide;
+
+  if (in >> wide)
+    {
+      if (wide > std::numeric_limits<T>::max ())
+        in.setstate (std::ios::failbit);
+      else
+        x = static_cast<T> (wide);
+    }
+
+  return in;
+}
+
+template<typename C, typename P> inline Participants<C, P> read_case (std::istream& in)
+{
+  P npeople = 0;
+  read (in, npeople);
+
+  C country = 0;
+  P end = 0, start = 0;
+
+  Participants<C, P> vec;
+  vec.reserve (npeople);
+
+  for (P i = 0; i < npeople; ++i)
+    {
+      read (read (read (in, start), end), country);
+      vec.push_back (country, start, end);
+    }
+
+  return (vec.sort (), vec);
+}
+
+template<typename C, typename P> inline P case_ (Participants<C, P>&& vec, const Options& options, WorkPool* pool, Stats* stats = nullptr, const Deadline* deadline = nullptr, Witness<C, P>* witness = nullptr)
+{
+  // With every country known no coincidence set needs building at all
+  if (std::none_of (vec.countries.begin (), vec.countries.end (), [](C c) { return c == 0; }))
+    {
+      auto phase = Stats::Phase (stats, &Stats::count);
+      std::vector<std::uint8_t> flags;
+      auto upset = upset_known (vec, witness != nullptr ? &flags : nullptr);
+
+      if (witness != nullptr) witness->record (vec, vec.countries, flags);
+      return upset;
+    }
+
+  auto coin = [&] () { auto phase = Stats::Phase (stats, &Stats::index); return Coincidence<P>::sweep (vec); } ();
+
+  if (stats != nullptr) stats->swept (coin);
+  return solve (std::move (vec), std::move (coin), options, pool, stats, deadline, witness);
+}
+
+/* Treap of intervals keyed by (start, id), ids being slots of the caller's
+ * own. Each node also keeps, over its subtree, the latest end (so overlap
+ * walks prune whole subtrees that end too early) and how many are `calm`
+ * and `zero` flagged, so any range of starts sums up in O(log n).
+ */
+template<typename P> class IntervalTreap
+{
+public:
+
+  using id_type = std::size_t;
+
+  struct Sum
+  {
+    P calm = 0, zeros = 0;
+  };
+
+private:
+
+  static constexpr id_type none = ~id_type (0);
+
+  struct Node
+  {
+    P start, end, latest;
+    bool calm, zero;
+    std::uint64_t priority;
+    id_type left, right;
+    Sum sum;
+  };
+
+  std::vector<Node> nodes;
+  id_type root = none;
+
+  inline bool less (id_type a, P start, id_type id) const
+    {
+      return nodes [a].start < start || (nodes [a].start == start && a < id);
+    }
+
+  inline void pull (id_type n)
+    {
+      auto& x = nodes [n];
+
+      (x.latest = x.end, x.sum = Sum { x.calm ? P (1) : P (0), x.zero ? P (1) : P (0) });
+
+      for (auto c : { x.left, x.right }) if (c != none)
+        {
+          x.latest = std::max (x.latest, nodes [c].latest);
+          (x.sum.calm += nodes [c].sum.calm, x.sum.zeros += nodes [c].sum.zeros);
+        }
+    }
+
+  /* Those before (start, id) go left, the rest right */
+  inline std::pair<id_type, id_type> split (id_type n, P start, id_type id)
+    {
+      if (n == none)
+
+        return std::make_pair (none, none);
+      else if (less (n, start, id))
+        {
+          auto [l, r] = split (nodes [n].right, start, id);
+          return (nodes [n].right = l, pull (n), std::make_pair (n, r));
+        }
+      else
+        {
+          auto [l, r] = split (nodes [n].left, start, id);
+          return (nodes [n].left = r, pull (n), std::make_pair (l, n));
+        }
+    }
+
+  inline id_type merge (id_type a, id_type b)
+    {
+      if (a == none || b == none)
+
+        return a == none ? b : a;
+      else if (nodes [a].priority > nodes [b].priority)
+
+        return (nodes [a].right = merge (nodes [a].right, b), pull (a), a);
+      else
+        return (nodes [b].left = merge (a, nodes [b].left), pull (b), b);
+    }
+
+  inline void touch (id_type n, id_type id)
+    {
+      if (n != id) touch (less (n, nodes [id].start, id) ? nodes [n].right : nodes [n].left, id);
+      pull (n);
+    }
+
+  template<typename F> inline void overlap (id_type n, P lo, P hi, F& f) const
+    {
+      if (n == none || nodes [n].latest < lo)
+
+        return;
+
+      overlap (nodes [n].left, lo, hi, f);
+
+      if (nodes [n].start <= hi)
+        {
+          if (nodes [n].end >= lo) f (n);
+          overlap (nodes [n].right, lo, hi, f);
+        }
+    }
+
+  /* Sum over the starts before `day`, or up to it when `inclusive` */
+  inline Sum prefix (P day, bool inclusive) const
+    {
+      Sum s;
+
+      for (auto n = root; n != none;)
+        {
+          const auto& x = nodes [n];
+
+          if (x.start < day || (inclusive && x.start == day))
+            {
+              if (x.left != none) (s.calm += nodes [x.left].sum.calm, s.zeros += nodes [x.left].sum.zeros);
+              (s.calm += x.calm ? 1 : 0, s.zeros += x.zero ? 1 : 0, n = x.right);
+            }
+          else
+            n = x.left;
+        }
+
+      return s;
+    }
+
+public:
+
+  inline void insert (id_type id, P start, P end, bool zero)
+    {
+      // Priorities hash the id (splitmix64), fixed however often it moves
+      auto h = 0x9e3779b97f4a7c15 * (1 + (std::uint64_t) id);
+
+      h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+      h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+
+      if (nodes.size () <= id) nodes.resize (1 + id);
+
+      nodes [id] = Node { start, end, end, true, zero, h ^ (h >> 31), none, none, Sum { } };
+      pull (id);
+
+      auto [l, r] = split (root, start, id);
+      root = merge (merge (l, id), r);
+    }
+
+  inline void erase (id_type id)
+    {
+      auto [l, r] = split (root, nodes [id].start, id);
+      auto [_, rest] = split (r, nodes [id].start, 1 + id);
+      root = merge (l, rest);
+    }
+
+  inline void set_calm (id_type id, bool calm)
+    {
+      if (nodes [id].calm != calm) (nodes [id].calm = calm, touch (root, id));
+    }
+
+  /* Calls f (id) for every interval meeting [lo, hi], by start */
+  template<typename F> inline void overlap (P lo, P hi, F&& f) const
+    {
+      overlap (root, lo, hi, f);
+    }
+
+  /* Sum over the intervals starting in [lo, hi] */
+  inline Sum sum (P lo, P hi) const
+    {
+      auto a = prefix (lo, false), b = prefix (hi, true);
+      return Sum { P (b.calm - a.calm), P (b.zeros - a.zeros) };
+    }
+};
+
+/* Participants under continuous change. Each one lies in a span, the day
+ * range of its overlap component (no two share a day, so their answers
+ * add up), and keeps `mismatch`, how many coinciding participants hold a
+ * different country value. An update walks only the intervals it meets
+ * to fix their counters, which the roster (an IntervalTreap) turns into
+ * calm counts by start, then re-evaluates only the spans it merged or
+ * split: where every country is known, a span's answer is its calm count,
+ * one O(log n) sum away. Spans holding unknowns only become `stale`
+ * instead, and query solves each of them once with case_, so a batch of
+ * updates between two queries costs one search per span it touched.
+ */
+template<typename C, typename P> class Itinerary
+{
+public:
+
+  using id_type = std::size_t;
+
+private:
+
+  struct Person
+  {
+    C country;
+    P start, end;
+    bool alive;
+  };
+
+  struct Span
+  {
+    P end;
+    P upset;
+  };
+
+  const Options& options;
+  WorkPool* pool;
+  std::vector<Person> people;
+  std::vector<P> mismatch;
+  IntervalTreap<P> roster;
+  std::map<P, Span> spans;
+  std::set<P> stale;
+  P total = 0;
+
+  inline void check (id_type id) const
+    {
+      if (id >= people.size () || people [id].alive == false)
+
+        std::__throw_out_of_range ("no such participant");
+    }
+
+  static inline void check (P start, P end)
+    {
+      if (start > end)
+
+        std::__throw_invalid_argument ("participant leaves before arriving");
+    }
+
+  /* Adds (by > 0) or takes back id's share of its neighbours' counters */
+  inline void walk (id_type id, int by)
+    {
+      const auto& x = people [id];
+
+      roster.overlap (x.start, x.end, [&](id_type q)
+        {
+          if (q != id && people [q].country != x.country)
+            {
+              if (by > 0) (++mismatch [q], ++mismatch [id]);
+              else (--mismatch [q], --mismatch [id]);
+
+              roster.set_calm (q, mismatch [q] == 0);
+            }
+        });
+
+      roster.set_calm (id, mismatch [id] == 0);
+    }
+
+  /* Spans with unknowns count nothing until query solves them */
+  inline void settle (P start, P end)
+    {
+      auto sum = roster.sum (start, end);
+      auto upset = sum.zeros == 0 ? sum.calm : P (0);
+
+      if (sum.zeros > 0) stale.insert (start);
+
+      spans.insert (std::make_pair (start, Span { end, upset }));
+      total += upset;
+    }
+
+  inline void unsettle (std::map<P, Span>::iterator& iter)
+    {
+      (stale.erase (iter->first), total -= iter->second.upset);
+      iter = spans.erase (iter);
+    }
+
+  inline void attach (id_type id)
+    {
+      const auto& x = people [id];
+      P start = x.start, end = x.end;
+
+      // Spans are disjoint and sorted, so the ones meeting x are contiguous
+      for (auto iter = spans.upper_bound (x.end); iter != spans.begin () && std::prev (iter)->second.end >= x.start;)
+        {
+          iter = std::prev (iter);
+          start = std::min (start, iter->first);
+          end = std::max (end, iter->second.end);
+          unsettle (iter);
+        }
+
+      mismatch [id] = 0;
+      roster.insert (id, x.start, x.end, x.country == 0);
+      walk (id, 1);
+      settle (start, end);
+    }
+
+  inline void detach (id_type id)
+    {
+      const auto& x = people [id];
+      auto iter = std::prev (spans.upper_bound (x.start));
+      auto start = iter->first;
+      auto end = iter->second.end;
+
+      unsettle (iter);
+      walk (id, -1);
+      roster.erase (id);
+
+      // Only days x held may empty: the rest of the span before x.start
+      // stays one piece, as does the rest after x.end, and whatever met x
+      // decides which pieces join
+      std::vector<std::pair<P, P>> pieces;
+
+      if (start < x.start) pieces.push_back (std::make_pair (start, x.start - 1));
+      if (end > x.end) pieces.push_back (std::make_pair (x.end + 1, end));
+
+      roster.overlap (x.start, x.end, [&](id_type q) { pieces.push_back (std::make_pair (people [q].start, people [q].end)); });
+      std::sort (pieces.begin (), pieces.end ());
+
+      for (std::size_t i = 0; i < pieces.size ();)
+        {
+          auto [a, b] = pieces [i];
+
+          for (++i; i < pieces.size () && std::get<0> (pieces [i]) <= b; ++i) b = std::max (b, std::get<1> (pieces [i]));
+          settle (a, b);
+        }
+    }
+
+public:
+
+  inline Itinerary (const Options& options, WorkPool* pool = nullptr) : options (options), pool (pool)
+    {
+    }
+
+  inline id_type add (C country, P start, P end)
+    {
+      check (start, end);
+      people.push_back (Person { country, start, end, true });
+      mismatch.push_back (0);
+      return (attach (people.size () - 1), people.size () - 1);
+    }
+
+  inline void remove (id_type id)
+    {
+      check (id);
+      detach (id);
+      people [id].alive = false;
+    }
+
+  /* Moves id to another country and/or dates, keeping its id */
+  inline void change (id_type id, C country, P start, P end)
+    {
+      check (id);
+      check (start, end);
+      detach (id);
+      people [id].country = country;
+      people [id].start = start;
+      people [id].end = end;
+      attach (id);
+    }
+
+  inline const Person& get (id_type id) const
+    {
+      return (check (id), people [id]);
+    }
+
+  /* Worst-case upset count of the current participants, solving the stale
+   * spans first (as pool tasks, when there is a pool)
+   */
+  inline P query ()
+    {
+      auto group = TaskGroup (pool);
+
+      for (const auto& start : stale)
+        {
+          auto& span = spans.at (start);
+          Participants<C, P> vec;
+
+          roster.overlap (start, span.end, [&](id_type q)
+            {
+              const auto& x = people [q];
+              vec.push_back (x.country, x.start, x.end);
+            });
+
+          group.spawn ([this, &span, vec = std::move (vec)] () mutable { span.upset = case_<C, P> (std::move (vec), options, pool); });
+        }
+
+      group.wait ();
+
+      for (const auto& start : stale) total += spans.at (start).upset;
+      return (stale.clear (), total);
+    }
+};
+
+/* --dynamic: one command per line on stdin, answering on stdout
+ *
+ *   add <start> <end> <country>     prints the new participant's id
+ *   remove <id>
+ *   change <id> <start> <end> <country>
+ *   country <id> <country>
+ *   dates <id> <start> <end>
+ *   query                           prints the upset count
+ */
+template<typename C, typename P> inline int itinerary (const Options& options)
+{
+  auto pool = options.threads == 1 ? nullptr : std::make_unique<WorkPool> (options.threads);
+  auto state = Itinerary<C, P> (options, pool.get ());
+  typename Itinerary<C, P>::id_type id = 0;
+  std::string command;
+  C country = 0;
+  P end = 0, start = 0;
+
+  while (std::cin >> command) try
+    {
+      if (command == "add" && read (read (read (std::cin, start), end), country))
+        std::cout << state.add (country, start, end) << '\n' << std::flush;
+      else if (command == "remove" && read (std::cin, id))
+        state.remove (id);
+      else if (command == "change" && read (read (read (read (std::cin, id), start), end), country))
+        state.change (id, country, start, end);
+      else if (command == "country" && read (read (std::cin, id), country))
+        state.change (id, country, state.get (id).start, state.get (id).end);
+      else if (command == "dates" && read (read (read (std::cin, id), start), end))
+        state.change (id, state.get (id).country, start, end);
+      else if (command == "query")
+        std::cout << state.query () << '\n' << std::flush;
+      else
+        {
+          std::cin.clear ();
+          std::cin.ignore (std::numeric_limits<std::streamsize>::max (), '\n');
+          std::cerr << "error: malformed command '" << command << "'" << std::endl;
+        }
+    }
+  catch (const std::exception& e)
+    {
+      std::cerr << "error: " << e.what () << std::endl;
+    }
+
+  return 0;
+}
+
+/* Reads every case up front and solves them as pool tasks (in order, when
+ * single threaded), then writes the answers in input order at once.
+ */
+template<typename C, typename P> inline int program (const Options& options)
+{
+  P ncases = 0;
+  read (std::cin, ncases);
+
+  std::vector<Participants<C, P>> cases;
+  cases.reserve (ncases);
+
+  for (P i = 0; i < ncases; ++i) cases.push_back (read_case<C, P> (std::cin));
+
+  auto pool = options.threads == 1 ? nullptr : std::make_unique<WorkPool> (options.threads);
+  auto group = TaskGroup (pool.get ());
+  std::vector<double> elapsed (ncases, 0);
+  std::vector<P> upset (ncases, 0);
+  std::vector<std::uint8_t> proven (ncases, true);
+  std::vector<Stats> stats (options.stats ? ncases : 0);
+  std::vector<Witness<C, P>> witness (options.witness ? ncases : 0);
+
+  for (P i = 0; i < ncases; ++i) group.spawn ([&, i] ()
+    {
+      auto start = std::chrono::steady_clock::now ();
+      auto deadline = Deadline (options.budget);
+
+      upset [i] = case_<C, P> (std::move (cases [i]), options, pool.get (), options.stats ? & stats [i] : nullptr, options.budget > 0 ? &deadline : nullptr, options.witness ? & witness [i] : nullptr);
+      proven [i] = deadline.get_expired () == false;
+
+      if (options.timing)
+
+        elapsed [i] = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+    });
+
+  group.wait ();
+
+  for (P i = 0; i < ncases; ++i) std::cout << upset [i] << '\n';
+  std::cout << std::flush;
+
+  if (options.timing)
+
+    for (P i = 0; i < ncases; ++i) std::cerr << "case " << i << ": " << elapsed [i] << " ms" << '\n';
+
+  if (options.stats)
+
+    for (P i = 0; i < ncases; ++i) stats [i].print (std::cerr, i);
+
+  if (options.witness)
+
+    for (P i = 0; i < ncases; ++i) witness [i].print (std::cerr, i);
+
+  // Answers cut short by --budget-ms are the best lower bounds found
+  if (options.budget > 0)
+
+    for (P i = 0; i < ncases; ++i) std::cerr << "case " << i << ": " << upset [i] << (proven [i] ? " optimal" : " lower bound") << '\n';
+
+  return 0;
+}
+
+static inline bool parse (int argc, char* argv [], Options* options)
+{
+  for (int i = 1; i < argc; ++i)
+    {
+      auto arg = std::string (argv [i]);
+      auto value = [&](const std::string& name) { return arg.substr (name.size ()); };
+
+      if (arg.starts_with ("--threads=") && value ("--threads=").find_first_not_of ("0123456789") == std::string::npos)
+        {
+          auto n = std::stoul ("0" + value ("--threads="));
+          options->threads = n > 0 ? n : std::max (1u, std::thread::hardware_concurrency ());
+        }
+      else if (arg.starts_with ("--memo=") && value ("--memo=").find_first_not_of ("0123456789") == std::string::npos)
+
+        options->memo = 1024 * std::stoull ("0" + value ("--memo="));
+      else if (arg.starts_with ("--budget-ms=") && value ("--budget-ms=").size () > 0 && value ("--budget-ms=").find_first_not_of ("0123456789") == std::string::npos)
+
+        options->budget = std::stod (value ("--budget-ms="));
+      else if (arg == "--dynamic") options->dynamic = true;
+      else if (arg == "--stats") options->stats = true;
+      else if (arg == "--timing") options->timing = true;
+      else if (arg == "--witness") options->witness = true;
+      else if (arg == "--engine=enumerate") options->engine = Engine::enumerate;
+      else if (arg == "--engine=delta") options->engine = Engine::delta;
+      else if (arg == "--engine=bnb") options->engine = Engine::bnb;
+      else if (arg == "--engine=dp") options->engine = Engine::dp;
+      else
+        {
+          std::cerr << "usage: " << argv [0] << " [--threads=N] [--engine=enumerate|delta|bnb|dp] [--memo=KiB] [--budget-ms=N] [--dynamic] [--stats] [--timing] [--witness]" << std::endl;
+          return false;
+        }
+    }
+
+  return true;
+}
+
+#if !defined (CONFERENCE_NO_MAIN)
+
+int main (int argc, char* argv [])
+{
+  Options options;
+
+  if (parse (argc, argv, &options) == false)
+
+    return 1;
+
+  std::ios::sync_with_stdio (false);
+
+  // Countries stay under 256 and days under 2^20
+  if (options.dynamic)
+    return itinerary<std::uint8_t, std::uint32_t> (options);
+  else
+    return program<std::uint8_t, std::uint32_t> (options);
+}
+
+#endif // !CONFERENCE_NO_MAIN
@@ -0,0 +1,132 @@
+# Copyright 2024-2025 MarcosHCK
+# This file is part of DAA-Final-Project.
+#
+# DAA-Final-Project is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DAA-Final-Project is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+#
+import random
+import sys
+
+def generate_case (npeople: int, ndays: int, length: int, ncountries: int, unknown: float):
+
+  people = []
+
+  for _ in range (npeople):
+
+    start = random.randint (1, ndays)
+    end = start + random.randint (0, length)
+    country = 0 if random.random () < unknown else random.randint (1, ncountries)
+
+    people.append ((start, end, country))
+
+  return people
+
+def read_cases (text: str):
+
+  numbers = iter (map (int, text.split ()))
+  cases = []
+
+  for _ in range (next (numbers)):
+
+    npeople = next (numbers)
+    cases.append ([ (next (numbers), next (numbers), next (numbers)) for _ in range (npeople) ])
+
+  return cases
+
+def random_person (ncountries: int):
+
+  start = random.randint (1, 20)
+  return (start, start + random.randint (0, 4), random.randint (0, ncountries))
+
+# Builds every case through --dynamic commands (detours included), queries
+# it twice (before and after moving some participants away and back) and
+# takes it down again, so each case expects its answer twice in a row
+def dynamic (cases):
+
+  lines = []
+  next_id = 0
+
+  def add (person):
+
+    nonlocal next_id
+    lines.append ('add %d %d %d' % person)
+    next_id += 1
+    return next_id - 1
+
+  for people in cases:
+
+    ids = []
+
+    for person in random.sample (people, len (people)):
+
+      kind = random.randint (0, 4)
+
+      if kind == 0:
+
+        ids.append ((add (random_person (3)), person))
+        lines.append ('change %d %d %d %d' % ((ids [-1] [0],) + person))
+
+      elif kind == 1:
+
+        ids.append ((add ((person [0], person [1], random.randint (0, 3))), person))
+        lines.append ('country %d %d' % (ids [-1] [0], person [2]))
+
+      elif kind == 2:
+
+        ids.append ((add (random_person (0) [:2] + (person [2],)), person))
+        lines.append ('dates %d %d %d' % (ids [-1] [0], person [0], person [1]))
+
+      else:
+
+        ids.append ((add (person), person))
+
+      if random.randint (0, 3) == 0:
+
+        lines.append ('remove %d' % add (random_person (3)))
+
+    lines.append ('query')
+
+    for i in random.sample (range (len (ids)), len (ids) // 2):
+
+      if random.randint (0, 1) == 0:
+
+        lines.append ('remove %d' % ids [i] [0])
+        ids [i] = (add (ids [i] [1]), ids [i] [1])
+      else:
+
+        lines.append ('change %d %d %d %d' % ((ids [i] [0],) + random_person (3)))
+        lines.append ('change %d %d %d %d' % ((ids [i] [0],) + ids [i] [1]))
+
+    lines.append ('query')
+    lines.extend ('remove %d' % i for i, _ in ids)
+
+  return lines
+
+if __name__ == '__main__':
+
+  if len (sys.argv) > 1 and sys.argv [1] == '--dynamic':
+
+    print ('\n'.join (dynamic (read_cases (sys.stdin.read ()))))
+  else:
+
+    ncases = random.randint (1, 10)
+
+    print (ncases)
+
+    for _ in range (ncases):
+
+      # Few unknowns, as the reference tries every country on each
+      people = generate_case (random.randint (1, 9), random.choice ([ 4, 8, 16 ]), random.choice ([ 0, 1, 2, 4 ]), random.choice ([ 2, 3, 4 ]), random.choice ([ 0.2, 0.5 ]))
+
+      print (len (people))
+      print ('\n'.join ('%d %d %d' % person for person in people))
@@ -0,0 +1,96 @@
+# Copyright 2024-2025 MarcosHCK
+# This file is part of DAA-Final-Project.
+#
+# DAA-Final-Project is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DAA-Final-Project is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+#
+brute='./brute'
+report='report'
+solver='./solution'
+tester='python3 ../test.py'
+witness='python3 ../witness.py'
+time='time\n  user: %U\n  system: %S\n  elapsed: %E\nmemory\n  shared: %X Kb\n  unshared: %D Kb\n  total: %M Kb'
+
+check ()
+  {
+    if [ "$1" = "$2" ];
+    then
+      echo 'ok'
+    else
+      echo "not ok: got $1"
+      echo -ne "$3" > failed
+      exit 1
+    fi
+  }
+
+test ()
+  {
+    sol=$1
+    got=`echo -ne "$2" | time -f "$time" -ao $report -- $sol`
+
+    check "$got" "$3" "$2"
+  }
+
+# Replays the printed witness, which must upset what the answer says
+test_witness ()
+  {
+    sol=$1
+    echo -ne "$2" > input
+    got=`echo -ne "$2" | time -f "$time" -ao $report -- $sol --witness 2>&1 | $witness input`
+
+    check "$got" 'ok' "$2"
+  }
+
+# Keeps the query answers only, as add prints ids on the same stream
+test_dynamic ()
+  {
+    sol=$1
+    script=`echo -ne "$2" | $tester --dynamic`
+    got=`echo "$script" | time -f "$time" -ao $report -- $sol --dynamic | paste <(echo "$script" | grep -E '^(add|query)') - | awk -F '\t' '$1 == "query" { print $2 }'`
+
+    check "$got" "$3" "$2"
+  }
+
+echo 'Tests' > $report
+
+echo 'case0.1:' >> $report
+test "$solver" '1\n3\n1 2 1\n2 3 1\n5 6 2\n' '3'
+echo 'case0.2:' >> $report
+test "$solver" '1\n2\n1 2 1\n2 3 2\n' '0'
+echo 'case0.3:' >> $report
+test "$solver" '1\n3\n1 1 0\n1 2 0\n5 5 0\n' '3'
+echo 'case0.4:' >> $report
+test "$solver" '1\n5\n1 2 1\n2 3 0\n3 4 0\n4 5 0\n5 6 2\n' '3'
+
+for ((i = 0; i < 10; i++));
+do
+  arg=`$tester`
+  want=`echo -ne "$arg" | "$brute"`
+
+  for engine in enumerate delta bnb dp;
+  do
+    for threads in 1 4;
+    do
+      echo "case$((i+1)) --engine=$engine --threads=$threads (should be" $want"):" >> $report
+      test "$solver --engine=$engine --threads=$threads" "$arg" "$want"
+      echo "case$((i+1)) --engine=$engine --threads=$threads --witness:" >> $report
+      test_witness "$solver --engine=$engine --threads=$threads" "$arg"
+    done
+  done
+
+  for threads in 1 4;
+  do
+    echo "case$((i+1)) --dynamic --threads=$threads:" >> $report
+    test_dynamic "$solver --threads=$threads" "$arg" "`echo "$want" | sed p`"
+  done
+done
@@ -0,0 +1,75 @@
+# Copyright 2024-2025 MarcosHCK
+# This file is part of DAA-Final-Project.
+#
+# DAA-Final-Project is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DAA-Final-Project is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
+#
+import re
+import sys
+
+from test import read_cases
+
+# Replays the assignment --witness printed for every case (solution output
+# on stdin, stderr included) and checks it upsets exactly the participants
+# listed, as many as the answer says
+def check (cases, answers, witness):
+
+  for i, people in enumerate (cases):
+
+    people = [ list (person) for person in people ]
+
+    for token in witness.get ((i, 'assigned'), []):
+
+      p, country = map (int, token.split (':'))
+
+      if people [p] [2] != 0 or country == 0:
+
+        return 'case %d: bad assignment %s' % (i, token)
+
+      people [p] [2] = country
+
+    if any (person [2] == 0 for person in people):
+
+      return 'case %d: unknowns left unassigned' % i
+
+    meet = lambda a, b: a [0] <= b [1] and b [0] <= a [1]
+    upset = [ p for p, a in enumerate (people) if all (a [2] == b [2] for b in people if meet (a, b)) ]
+
+    if len (upset) != answers [i]:
+
+      return 'case %d: witness upsets %d, answer is %d' % (i, len (upset), answers [i])
+
+    if upset != sorted (map (int, witness.get ((i, 'upset'), []))):
+
+      return 'case %d: upset participants differ' % i
+
+  return 'ok'
+
+if __name__ == '__main__':
+
+  answers = []
+  witness = {}
+
+  for line in sys.stdin:
+
+    if (match := re.match (r'case (\d+): (assigned|upset)(.*)', line)) is not None:
+
+      witness [(int (match [1]), match [2])] = match [3].split ()
+
+    elif line.strip ().isdigit ():
+
+      answers.append (int (line))
+
+  with open (sys.argv [1]) as input:
+
+    print (check (read_cases (input.read ()), answers, witness))
@@ -15,14 +15,21 @@
  * along with DAA-Final-Project. If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <memory>
 #include <set>
 #include <span>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
+#include <workpool.hpp>
 
 template<typename T, int dims> class Point : public std::array<T, dims>
 {
@@ -57,19 +64,28 @@ template<typename T> class Deletable
 private:
   bool deleted = false;
   const Rectangle<T>* value = nullptr;
+  std::array<std::size_t, 4> indices = { };
 public:
 
   inline Deletable (const Rectangle<T>* v) : value (v) { }
 
   inline constexpr const bool get_deleted () const { return deleted; }
+  inline constexpr std::size_t get_index (int axis) const { return indices [axis]; }
   inline constexpr const Rectangle<T>* get_value () const { return value; }
   inline constexpr const T& get_x0 () const noexcept { return value->get_x0 (); }
   inline constexpr const T& get_x1 () const noexcept { return value->get_x1 (); }
   inline constexpr const T& get_y0 () const noexcept { return value->get_y0 (); }
   inline constexpr const T& get_y1 () const noexcept { return value->get_y1 (); }
   inline constexpr void set_deleted (bool value) { deleted = value; }
+  inline constexpr void set_index (int axis, std::size_t index) { indices [axis] = index; }
 };
 
+/* The same rectangles in each tree's order, by sort key: ascending x0 and
+ * y0, descending x1 and y1 (indexed as Rectangle's X0, Y0, X1 and Y1)
+ */
+template<typename T> using Orders = std::array<std::vector<Deletable<T> *>, 4>;
+template<typename T> using Views = std::array<std::span<Deletable<T> *>, 4>;
+
 class MaybeNot
 {
 public:
@@ -142,185 +158,185 @@ namespace std
   static inline constexpr Maybe<T> make_maybe (T&& value) { return Maybe<T> (std::move (value)); }
 }
 
+/* Bottom-up segment tree over 2 * size slots: leaves sit at [size, 2 * size)
+ * and slot i > 0 joins slots 2i and 2i + 1. Slots hold N's key of each
+ * value (a coordinate, not the rectangle), and N::none once it is deleted.
+ * Whether a leaf is live is up to N::live and `alive` alone, never to its
+ * key, as N::none (the join identity) is a valid coordinate too. Deleted
+ * leaves are skipped through `alive`, a union-find pointing each one
+ * further right (path compressed), so walking the live values costs near
+ * O(1) a step however many were deleted.
+ */
 template<typename T, typename N> class SegmentTree
 {
 public:
   using size_type = std::vector<T>::size_type;
+  using value_type = N::value_type;
 protected:
-  static inline size_type left (size_type node) { return 2 * node + 1; }
-  static inline size_type mid (size_type l, size_type r) { return l + (r - l) / 2; }
-  static inline size_type right (size_type node) { return 2 * node + 2; }
-
-  std::map<T, size_type> fastidx;
   size_type size;
   std::vector<T> store;
-  std::vector<N> tree;
+  std::vector<value_type> tree;
+  std::vector<size_type> alive;
 
-  inline const N* build (size_type node, size_type start, size_type end)
+  inline void kill (size_type idx)
     {
-      if (start == end)
-        {
-          auto n = N (store [start]);
-          fastidx.insert (std::make_pair (store [start], start));
-          return (tree [node] = n, & tree [node]);
-        }
-      else
-        {
-          auto m = mid (start, end);
-          auto l = build (left (node), start, m);
-          auto r = build (right (node), m + 1, end);
+      alive [idx] = idx + 1;
+    }
 
-          return (tree [node] = N (*l, *r), & tree [node]);
-        }
+  inline void pull (size_type l, size_type r)
+    {
+      for (l >>= 1, r >>= 1; l > 0; l >>= 1, r >>= 1)
+
+        for (auto i = l; i <= r; ++i) tree [i] = N::join (tree [2 * i], tree [2 * i + 1]);
     }
 
-  inline const N query (size_type node, size_type start, size_type end, size_type l, size_type r)
+public:
+
+  inline SegmentTree (std::vector<T>&& vec) : size (vec.size ()), store (std::move (vec)), tree (2 * size, N::none), alive (1 + size)
     {
-      if (r < start || end < l)
+      for (size_type i = 0; i <= size; ++i) alive [i] = i;
+      for (size_type i = 0; i < size; ++i) if ((tree [size + i] = N::get (store [i]), N::live (store [i])) == false) kill (i);
+      for (size_type i = size - 1; i > 0; --i) tree [i] = N::join (tree [2 * i], tree [2 * i + 1]);
+    }
 
-        return N ();
+  inline constexpr std::span<T> get_values () { return std::span (store); }
 
-      if (l <= start && end <= r)
+  inline bool live (size_type idx) const
+    {
+      return alive [idx] == idx;
+    }
 
-        return tree [node];
-      else
-        {
-          auto m = mid (start, end);
-          auto l_ = query (left (node), start, m, l, r);
-          auto r_ = query (right (node), m + 1, end, l, r);
-          return N (l_, r_);
-        }
+  /* First live leaf at idx or after it (size if none) */
+  inline size_type next (size_type idx)
+    {
+      auto root = idx;
+
+      while (alive [root] != root) root = alive [root];
+      while (alive [idx] != root) idx = std::exchange (alive [idx], root);
+      return root;
     }
 
-  inline const N* update (size_type node, size_type start, size_type end, size_type l, size_type r)
+  /* Join of leaves [l, r] */
+  inline value_type query (size_type l, size_type r) const
     {
-      if (start == end)
+      auto most = N::none;
+
+      for (l += size, r += size + 1; l < r; l >>= 1, r >>= 1)
         {
-          auto n = N (store [start]);
-          return (tree [node] = n, & tree [node]);
+          if (l & 1) most = N::join (most, tree [l++]);
+          if (r & 1) most = N::join (most, tree [--r]);
         }
-      else
-        {
-          auto m = mid (start, end);
 
-          if (l > m)
-            {
-              auto l_ = & tree [left (node)];
-              auto r_ = update (right (node), m + 1, end, l, r);
-              return (tree [node] = N (*l_, *r_), & tree [node]);
-            }
-          else if (m >= r)
-            {
-              auto l_ = update (left (node), start, m, l, r);
-              auto r_ = & tree [right (node)];
-              return (tree [node] = N (*l_, *r_), & tree [node]);
-            }
-          else
-            {
-              auto l_ = update (left (node), start, m, l, r);
-              auto r_ = update (right (node), m + 1, end, l, r);
-              return (tree [node] = N (*l_, *r_), & tree [node]);
-            }
-        }
+      return most;
     }
 
-public:
-
-  inline SegmentTree (const std::span<T>& vec) : size (vec.size ()), store (vec.begin (), vec.end ()), tree (4 * size)
+  /* Empties leaf idx for good */
+  inline void erase (size_type idx)
     {
-      build (0, 0, size - 1);
+      (tree [size + idx] = N::none, kill (idx));
+      pull (size + idx, size + idx);
     }
+};
 
-  inline constexpr std::span<T> get_values () { return std::span (store); }
+class Schedule;
 
-  inline const N query (size_type l, size_type r)
-    {
-      return query (0, 0, size - 1, l, r);
-    }
+template<typename T, typename L>
+inline bool collect (const Views<T>& views, L&& live, int depth, Schedule& schedule);
+template<typename T>
+bool solve (std::span<Rectangle<T>*>&& rects, WorkPool* pool);
+template<typename T>
+inline bool solve (Orders<T>&& orders, int depth, Schedule& schedule);
+template<typename T, typename L, typename size_type = typename std::span<Deletable<T> *>::size_type>
+inline Orders<T> split (const Views<T>& views, L&& live, int axis, size_type last, size_type second);
+
+/* Where the parts of one instance get solved. Without a pool every part
+ * recurses in place; with one, parts of at least `grain` rectangles become
+ * tasks of their own, as no part ever reads another's rectangles. The
+ * first part found uncuttable raises `failed`, which every other solve
+ * polls between checks to give up early.
+ */
+class Schedule
+{
+private:
+  TaskGroup group;
+  WorkPool* pool;
+  std::atomic<bool> failed = false;
+public:
+  static constexpr std::size_t grain = 1 << 12;
+
+  inline Schedule (WorkPool* pool) : group (pool), pool (pool) { }
 
-  inline void update ()
+  inline bool cancelled () const
     {
-      update (0, 0, size - 1, 0, size - 1);
+      return failed.load (std::memory_order_relaxed);
     }
 
-  inline void update (const T& hint)
+  /* Solves part now or later; false only if it failed now */
+  template<typename T> inline bool descend (Orders<T>&& part, int depth)
     {
-      auto idx = fastidx [hint];
-      update (0, 0, size - 1, idx, idx);
+      if (pool == nullptr || part [0].size () < grain)
+
+        return solve (std::move (part), depth, *this);
+      else
+        {
+          group.spawn ([this, depth, part = std::move (part)] () mutable
+            {
+              if (! solve (std::move (part), depth, *this)) failed = true;
+            });
+          return true;
+        }
     }
 
-  inline void update (size_type l, size_type r)
+  /* Joins every part spawned so far, given how the root one went */
+  inline bool join (bool solved)
     {
-      update (0, 0, size - 1, l, r);
+      if (solved == false) failed = true;
+      return (group.wait (), ! failed);
     }
 };
 
-template<typename T, std::array<T, 0>::size_type size>
-inline const T& array_min (const std::array<T, size>& ar);
-template<typename T, std::array<T, 0>::size_type size, int ... Is>
-inline const T& array_min_helper (const std::array<T, size>& ar, std::integer_sequence<int, Is ...> const&);
-template<typename T, typename size_type = typename std::span<Deletable<T> *>::size_type>
-inline bool collect (std::vector<Deletable<T> *>&& vec, std::array<size_type, 4>&& lasts, int depth);
-template<typename T, typename Ti>
-bool solve (std::span<Rectangle<T>*>&& rects);
-template<typename T>
-inline bool solve (std::vector<Deletable<T>*>&& rects, int depth);
-template<typename T, typename size_type = typename std::span<Deletable<T> *>::size_type>
-inline std::vector<Deletable<T> *> split (const std::span<Deletable<T> *>& vec, size_type last, size_type second);
-
 template<typename T, typename M, int I> class NodeMax
 {
-  M most = std::numeric_limits<M>::min ();
 public:
+  using value_type = M;
+  static constexpr M none = std::numeric_limits<M>::min ();
 
-  inline NodeMax () {}
-  inline NodeMax (const NodeMax& o) : most (o.most) { }
-  inline NodeMax (const T& v) : most (v->get_deleted () == false ? std::get<M, I> (v) : std::numeric_limits<M>::min ()) { }
-  inline NodeMax (const NodeMax& l, const NodeMax& r) : most (std::max (l.most, r.most)) { }
-  inline constexpr const M& get_most () const { return most; }
+  static inline constexpr bool live (const T& v) { return v->get_deleted () == false; }
+  static inline constexpr M get (const T& v) { return live (v) ? std::get<M, I> (v) : none; }
+  static inline constexpr M join (const M& l, const M& r) { return std::max (l, r); }
 };
 
 template<typename T, typename M, int I> class NodeMin
 {
-  M most = std::numeric_limits<M>::max ();
 public:
+  using value_type = M;
+  static constexpr M none = std::numeric_limits<M>::max ();
 
-  inline NodeMin () {}
-  inline NodeMin (const NodeMin& o) : most (o.most) { }
-  inline NodeMin (const T& v) : most (v->get_deleted () == false ? std::get<M, I> (v) : std::numeric_limits<M>::max ()) { }
-  inline NodeMin (const NodeMin& l, const NodeMin& r) : most (std::min (l.most, r.most)) { }
-  inline constexpr const M& get_most () const { return most; }
+  static inline constexpr bool live (const T& v) { return v->get_deleted () == false; }
+  static inline constexpr M get (const T& v) { return live (v) ? std::get<M, I> (v) : none; }
+  static inline constexpr M join (const M& l, const M& r) { return std::min (l, r); }
 };
 
-template<typename T, std::array<T, 0>::size_type size> inline const T& array_min (const std::array<T, size>& ar)
-{
-  static_assert (size > 0);
-  return array_min_helper (ar, std::make_integer_sequence<int, size> ());
-}
-
-template<typename T, std::array<T, 0>::size_type size, int ... Is> inline const T& array_min_helper (const std::array<T, size>& ar, std::integer_sequence<int, Is ...> const&)
+/* Whatever no cut took away, in every order and still sorted; false when
+ * nothing was cut at all
+ */
+template<typename T, typename L> inline bool collect (const Views<T>& views, L&& live, int depth, Schedule& schedule)
 {
-  Maybe<T> value;
-  using unused = int [];
-  (void) unused { (value = (value.is_none () ? ar [Is] : (ar [Is] < *value ? ar [Is] : *value)), 0)... };
-  return *value;
-}
+  Orders<T> descent;
 
-template<typename T, typename size_type> inline bool collect (std::vector<Deletable<T> *>&& vec, std::array<size_type, 4>&& lasts, int depth)
-{
-  std::vector<Deletable<T> *> descent;
+  for (std::size_t axis = 0; axis < views.size (); ++axis)
 
-  for (size_type i = array_min (lasts); i < vec.size (); ++i) if (vec [i]->get_deleted () == false)
-    descent.push_back (std::move (vec [i]));
+    for (std::size_t i = 0; i < views [axis].size (); ++i) if (live (axis, i))
+      descent [axis].push_back (views [axis] [i]);
 
-  if (descent.size () == vec.size () && vec.size () > 0)
+  if (descent [0].size () == views [0].size () && views [0].size () > 0)
 
     return false;
   else
-    return solve (std::move (descent), 1 + depth);
+    return solve (std::move (descent), 1 + depth, schedule);
 }
 
-template<typename T, typename Ti> inline int program ()
+template<typename T, typename Ti> inline int program (unsigned threads)
 {
   Ti nrects;
   Rectangle<T>* rects;
@@ -338,7 +354,9 @@ template<typename T, typename Ti> inline int program ()
       rectv.push_back (new (& rects [i]) Rectangle<T> (x0, y0, x1, y1));
     }
 
-  std::cout << (! solve (std::span (rectv)) ? "NO" : "YES") << std::endl;
+  auto pool = threads > 1 ? std::make_unique<WorkPool> (threads) : nullptr;
+
+  std::cout << (! solve (std::span (rectv), pool.get ()) ? "NO" : "YES") << std::endl;
 
   for (Ti i = 0; i < nrects; ++i)
     {
@@ -348,32 +366,29 @@ template<typename T, typename Ti> inline int program ()
   return (free (rects), 0);
 }
 
-template<typename T, typename ST = typename std::vector<Deletable<T>*>::size_type> inline Maybe<ST> find_hold (const std::span<Deletable<T>*>& rects, ST hold)
+template<typename Tree, typename ST = typename Tree::size_type> inline Maybe<ST> find_hold (Tree& tree, ST hold)
 {
-  for (ST i = hold; i < rects.size (); ++i) if (rects [i]->get_deleted () == false)
-    return std::make_maybe<ST> (i);
-    return Maybe<ST> ();
+  auto i = tree.next (hold);
+  return i < tree.get_values ().size () ? std::make_maybe<ST> (i) : Maybe<ST> ();
 }
 
-template<typename T, typename ST = typename std::vector<Deletable<T>*>::size_type> inline Maybe<ST> find_next (const std::span<Deletable<T>*>& rects, ST skip)
+template<typename Tree, typename ST = typename Tree::size_type> inline Maybe<ST> find_next (Tree& tree, ST skip)
 {
-  for (ST i = skip + 1; i < rects.size (); ++i) if (rects [i]->get_deleted () == false)
-    return std::make_maybe<ST> (i);
-    return Maybe<ST> ();
+  return find_hold (tree, 1 + skip);
 }
 
-template<typename T> inline bool solve (std::vector<Deletable<T> *>&& rects, int depth)
+template<typename T> inline bool solve (Orders<T>&& orders, int depth, Schedule& schedule)
 {
   using size_type = std::span<Rectangle<T>*>::size_type;
 
-  if (rects.size () < 2)
+  if (orders [0].size () < 2)
     {
-      for (auto& r : rects) r->set_deleted (true);
+      for (auto& r : orders [0]) r->set_deleted (true);
       return true;
     }
   else
     {
-      size_type checks, cuts = 1;
+      size_type checks = 1, cuts = 1;
       Maybe<size_type> firstxl = 0;
       Maybe<size_type> firstyl = 0;
       Maybe<size_type> firstxr = 0;
@@ -382,85 +397,173 @@ template<typename T> inline bool solve (std::vector<Deletable<T> *>&& rects, int
       size_t lastxr = 0, lastyr = 0;
       Maybe<size_type> second;
 
-      std::sort (rects.begin (), rects.end (), [](const Deletable<T>* a, const Deletable<T>* b)
-        { return a->get_x0 () < b->get_x0 (); });
-        auto x0tree = SegmentTree<Deletable<T> *, NodeMax<Deletable<T> *, T, Rectangle<T>::X1>> (rects);
-      std::sort (rects.begin (), rects.end (), [](const Deletable<T>* a, const Deletable<T>* b)
-        { return a->get_y0 () < b->get_y0 (); });
-        auto y0tree = SegmentTree<Deletable<T> *, NodeMax<Deletable<T> *, T, Rectangle<T>::Y1>> (rects);
-      std::sort (rects.begin (), rects.end (), [](const Deletable<T>* a, const Deletable<T>* b)
-        { return a->get_x1 () > b->get_x1 (); });
-        auto x1tree = SegmentTree<Deletable<T> *, NodeMin<Deletable<T> *, T, Rectangle<T>::X0>> (rects);
-      std::sort (rects.begin (), rects.end (), [](const Deletable<T>* a, const Deletable<T>* b)
-        { return a->get_y1 () > b->get_y1 (); });
-        auto y1tree = SegmentTree<Deletable<T> *, NodeMin<Deletable<T> *, T, Rectangle<T>::Y0>> (rects);
+      // Each rectangle remembers its leaf in every tree (by sort key)
+      for (std::size_t axis = 0; axis < orders.size (); ++axis)
+
+        for (size_type i = 0; i < orders [axis].size (); ++i) orders [axis] [i]->set_index (axis, i);
+
+      auto x0tree = SegmentTree<Deletable<T> *, NodeMax<Deletable<T> *, T, Rectangle<T>::X1>> (std::move (orders [Rectangle<T>::X0]));
+      auto y0tree = SegmentTree<Deletable<T> *, NodeMax<Deletable<T> *, T, Rectangle<T>::Y1>> (std::move (orders [Rectangle<T>::Y0]));
+      auto x1tree = SegmentTree<Deletable<T> *, NodeMin<Deletable<T> *, T, Rectangle<T>::X0>> (std::move (orders [Rectangle<T>::X1]));
+      auto y1tree = SegmentTree<Deletable<T> *, NodeMin<Deletable<T> *, T, Rectangle<T>::Y0>> (std::move (orders [Rectangle<T>::Y1]));
+      auto views = Views<T> { x0tree.get_values (), y0tree.get_values (), x1tree.get_values (), y1tree.get_values () };
+      auto live = [&](int axis, size_type i)
+        {
+          switch (axis)
+            {
+              case Rectangle<T>::X0: return x0tree.live (i);
+              case Rectangle<T>::Y0: return y0tree.live (i);
+              case Rectangle<T>::X1: return x1tree.live (i);
+              default: return y1tree.live (i);
+            }
+        };
 
       while (cuts > 0)
         {
           cuts = 0;
-        #define CHECKBLOCK(tree,first,last,axis,op,debugprefix,other1,other2,other3) \
+        /* The split part leaves all four trees before it descends, through
+         * the leaf indices its own solve rewrites for its own trees: from
+         * then on it may run on another thread, and this one only looks at
+         * its live leaves (never at the part's rectangles) again
+         */
+        #define CHECKBLOCK(tree,first,last,axis,op,debugprefix,other1,axis1,other2,axis2,other3,axis3) \
           if (first.is_none () == false) \
-          if ((first = find_hold (tree.get_values (), *first)).is_none () == false) \
+          if ((first = find_hold (tree, *first)).is_none () == false) \
             { \
-          if ((second = find_next (tree.get_values (), *first)).is_none () == false) \
+          if ((second = find_next (tree, *first)).is_none () == false) \
             { \
               ++checks; \
-              if (std::get<T, axis> (tree.get_values () [*second]) op tree.query (last, *first).get_most ()) \
+              if (std::get<T, axis> (tree.get_values () [*second]) op tree.query (last, *first)) \
                 first = *second; \
               else \
                 { \
-                  if (! solve (split (tree.get_values (), last, *second), 1 + depth)) \
-                    return false; \
-                  tree.update (last, *second); \
-                  if (true) \
+                  auto part = split (views, live, axis, last, *second); \
+                  for (const auto& r : part [0]) \
                     { \
-                      auto ar = tree.get_values ().subspan (last, *second - last); \
-                      for (const auto& r : ar) other1.update (r); \
-                      for (const auto& r : ar) other2.update (r); \
-                      for (const auto& r : ar) other3.update (r); \
+                      tree.erase (r->get_index (axis)); \
+                      other1.erase (r->get_index (axis1)); \
+                      other2.erase (r->get_index (axis2)); \
+                      other3.erase (r->get_index (axis3)); \
                     } \
+                  if (! schedule.descend (std::move (part), 1 + depth)) \
+                    return false; \
                   first = (last = *second); \
                   ++cuts; \
                 } } }
 
           while (checks > 0)
             {
+              if (schedule.cancelled ())
+
+                return false;
+
               checks = 0;
-              CHECKBLOCK (x0tree, firstxl, lastxl, Rectangle<T>::X0, <, "left on x", y0tree, x1tree, y1tree)
-              CHECKBLOCK (y0tree, firstyl, lastyl, Rectangle<T>::Y0, <, "left on y", x0tree, x1tree, y1tree)
-              CHECKBLOCK (x1tree, firstxr, lastxr, Rectangle<T>::X1, >, "right on x", x0tree, y0tree, y1tree)
-              CHECKBLOCK (y1tree, firstyr, lastyr, Rectangle<T>::Y1, >, "right on y", x0tree, y0tree, x1tree)
+              CHECKBLOCK (x0tree, firstxl, lastxl, Rectangle<T>::X0, <, "left on x", y0tree, Rectangle<T>::Y0, x1tree, Rectangle<T>::X1, y1tree, Rectangle<T>::Y1)
+              CHECKBLOCK (y0tree, firstyl, lastyl, Rectangle<T>::Y0, <, "left on y", x0tree, Rectangle<T>::X0, x1tree, Rectangle<T>::X1, y1tree, Rectangle<T>::Y1)
+              CHECKBLOCK (x1tree, firstxr, lastxr, Rectangle<T>::X1, >, "right on x", x0tree, Rectangle<T>::X0, y0tree, Rectangle<T>::Y0, y1tree, Rectangle<T>::Y1)
+              CHECKBLOCK (y1tree, firstyr, lastyr, Rectangle<T>::Y1, >, "right on y", x0tree, Rectangle<T>::X0, y0tree, Rectangle<T>::Y0, x1tree, Rectangle<T>::X1)
             }
         #undef CHECKBLOCK
         }
 
-      return collect (std::move (rects), { lastxl, lastyl, lastxr, lastyr }, 1 + depth);
+      return collect (views, live, 1 + depth, schedule);
     }
 }
 
-template<typename T, typename size_type> inline std::vector<Deletable<T> *> split (const std::span<Deletable<T> *>& vec, size_type last, size_type second)
+/* Leaves [last, second) of the tree on `axis`, still alive, in the four
+ * orders. They come sorted already along `axis`; along the other ones a
+ * small part sorts its leaf indices there, and a larger one is picked out
+ * of the parent's order in a linear pass, whichever costs less.
+ */
+template<typename T, typename L, typename size_type> inline Orders<T> split (const Views<T>& views, L&& live, int axis, size_type last, size_type second)
 {
-  std::vector<Deletable<T> *> descent;
+  Orders<T> descent;
+  std::vector<Deletable<T> *> own;
+
+  for (size_type i = last; i < second; ++i) if (live (axis, i))
+    own.push_back (views [axis] [i]);
 
-  // Wild guess
-  descent.reserve (second - last);
+  // Parts too small to cut need no order at all, as solve only reads the first
+  if (own.size () < 2)
+
+    return (descent [0] = std::move (own), descent);
+
+  for (int other = 0; other < (int) views.size (); ++other) if (other != axis)
+    {
+      auto& into = descent [other];
+      auto k = own.size ();
 
-  for (size_type i = last; i < second; ++i) if (vec [i]->get_deleted () == false)
-    descent.push_back (vec [i]);
+      into.reserve (k);
 
-  return std::move (descent);
+      if (k * std::bit_width (k) < views [other].size ())
+        {
+          std::vector<size_type> at;
+
+          at.reserve (k);
+          for (const auto& r : own) at.push_back (r->get_index (other));
+          std::sort (at.begin (), at.end ());
+          for (const auto& i : at) into.push_back (views [other] [i]);
+        }
+      else
+        for (size_type i = 0; i < views [other].size (); ++i) if (live (other, i))
+          {
+            const auto& r = views [other] [i];
+            if (r->get_index (axis) >= last && r->get_index (axis) < second) into.push_back (r);
+          }
+    }
+
+  return (descent [axis] = std::move (own), descent);
+}
+
+/* Sorts the four orders once; recursion only ever splits them */
+template<typename T> inline bool solve (std::span<Rectangle<T> *>&& rects, WorkPool* pool)
+{
+  Orders<T> orders;
+
+  orders [0].reserve (rects.size ());
+  for (const auto& r : rects) orders [0].push_back (new Deletable<T> (r));
+  for (std::size_t axis = 1; axis < orders.size (); ++axis) orders [axis] = orders [0];
+
+  auto by = [&orders](int axis, auto&& less) { std::sort (orders [axis].begin (), orders [axis].end (), less); };
+
+  by (Rectangle<T>::X0, [](const Deletable<T>* a, const Deletable<T>* b) { return a->get_x0 () < b->get_x0 (); });
+  by (Rectangle<T>::Y0, [](const Deletable<T>* a, const Deletable<T>* b) { return a->get_y0 () < b->get_y0 (); });
+  by (Rectangle<T>::X1, [](const Deletable<T>* a, const Deletable<T>* b) { return a->get_x1 () > b->get_x1 (); });
+  by (Rectangle<T>::Y1, [](const Deletable<T>* a, const Deletable<T>* b) { return a->get_y1 () > b->get_y1 (); });
+
+  Schedule schedule (pool);
+  return schedule.join (solve<T> (std::move (orders), 0, schedule));
 }
 
-template<typename T> inline bool solve (std::span<Rectangle<T> *>&& rects)
+static inline bool parse (int argc, char* argv [], unsigned* threads)
 {
-  std::vector<Deletable<T> *> descent;
+  for (int i = 1; i < argc; ++i)
+    {
+      auto arg = std::string (argv [i]);
+      auto value = [&](const std::string& name) { return arg.substr (name.size ()); };
+
+      if (arg.starts_with ("--threads=") && value ("--threads=").find_first_not_of ("0123456789") == std::string::npos)
+        {
+          auto n = std::stoul ("0" + value ("--threads="));
+          *threads = n > 0 ? n : std::max (1u, std::thread::hardware_concurrency ());
+        }
+      else
+        {
+          std::cerr << "usage: " << argv [0] << " [--threads=N]" << std::endl;
+          return false;
+        }
+    }
 
-  descent.reserve (rects.size ());
-  for (const auto& r : rects) descent.push_back (new Deletable<T> (r));
-  return solve<T> (std::move (descent), 0);
+  return true;
 }
 
-int main ()
+int main (int argc, char* argv [])
 {
-  return program<unsigned long, int> ();
+  unsigned threads = 1;
+
+  if (parse (argc, argv, &threads) == false)
+
+    return 1;
+
+  return program<unsigned long, int> (threads);
 }